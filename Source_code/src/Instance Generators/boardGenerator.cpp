@@ -1,66 +1,107 @@
 #include "boardGenerator.h"
 #include "../Utilities/utils.h"
-#include <random>
+#include "../Utilities/distanceProvider.h"
 #include <chrono>
+#include <cmath>
+#include <mutex>
 
 /**
  * @file boardGenerator.h/cpp
  * @brief Handles generation of boards of various kinds.
  */
 
+// Boards are saved one at a time (coordinates and distances of a board together, see saveBoard)
+static std::mutex saveMutex;
+
+static void forRows(int numHoles, threadPool* pool, const chunkBody& rows) {
+    /* Run rows on blocks of consecutive rows, on the workers of pool (nullptr: on the calling thread) */
+    if (pool == nullptr)
+        rows(0, numHoles, 0);
+    else
+        pool->parallelFor(numHoles, pool->chunkFor(numHoles), rows);
+}
+
+void boardGenerator::saveBoard(std::deque<std::pair<double, double>>& coordMat, int numHoles, doubleMap& times) {
+    /**
+    * Save the coordinates and the distances of a board, in one critical section: the two files always describe
+    * the same board
+    * -- Parameters --
+    * std::deque<std::pair<double, double>>& coordMat   : coordinates of the holes
+    * int numHoles                                      : number of holes (names the files)
+    * doubleMap& times                                  : distances between the holes
+    * */
+    std::lock_guard<std::mutex> lock(saveMutex);
+    Utils::saveCoordsToCSV(coordMat, numHoles);
+    Utils::saveToDAT(times);
+}
+
+uint64_t boardGenerator::boardSeed(uint64_t seed) {
+    /**
+    * -- Parameters --
+    * uint64_t seed     : seed of the board (0: time-based)
+    * -- Return --
+    * The seed to draw the board from
+    * */
+    return (seed != 0) ? seed
+                       : static_cast<uint64_t>(std::chrono::high_resolution_clock::now().time_since_epoch().count());
+}
+
 // times == c_i_j
-void boardGenerator::generateAsymBoard(doubleMap& times, int numHoles, double ub) {
+void boardGenerator::generateAsymBoard(doubleMap& times, int numHoles, double ub, uint64_t seed, threadPool* pool) {
     /**
     * Generate an instance with random weights for edges. Edges are asymmetric.
     * (a->b) != (b->a). Mostly for debugging, as the test are ran on symmetric TSP instances.
     * -- Parameters --
-    * doubleMap& times      : Matrix (vector of vectors) of distances/times to be filled
+    * doubleMap& times      : Matrix of distances/times to be filled
     * int numHoles          : number of cities/holes to be generated
     * double ub             : the upper bound on the random value to be generated (minimum is 1.0)
+    * uint64_t seed         : seed of the board (0: time-based)
+    * threadPool* pool      : workers filling the rows (nullptr: calling thread only)
      * */
-    times.resize(numHoles);
-    std::random_device rng;
-    std::mt19937 gen(rng());
-    std::uniform_real_distribution<> distribution(1.0, ub);
-    for (int i = 0; i < numHoles; i++) {
-        times[i].resize(numHoles);
-        for (int j = 0; j < numHoles; j++){
-            if (i == j)
-                times[i][j] = 0.0;
-            else {
-                double t = distribution(gen);
-                times[i][j] = t;
+    times.resize(numHoles, numHoles);
+    seed = boardSeed(seed);
+    // Row i is drawn from stream i: rows may be filled in any order
+    forRows(numHoles, pool, [&times, numHoles, ub, seed](int first, int last, unsigned) {
+        for (int i = first; i < last; i++) {
+            rngStream rng(seed, static_cast<uint64_t>(i));
+            for (int j = 0; j < numHoles; j++){
+                if (i == j)
+                    times[i][j] = 0.0;
+                else
+                    times[i][j] = 1.0 + (ub - 1.0) * rng.nextDouble();
             }
         }
-    }
+    });
 }
 
-void boardGenerator::generateSymBoard(doubleMap& times, int numHoles, double ub) {
+void boardGenerator::generateSymBoard(doubleMap& times, int numHoles, double ub, uint64_t seed, threadPool* pool) {
     /**
     * Generate an instance with random weights for edges. Edges are symmetric.
     * (a->b) == (b->a) for all edges.
     * -- Parameters --
-    * doubleMap& times      : Matrix (vector of vectors) of distances/times to be filled
+    * doubleMap& times      : Matrix of distances/times to be filled
     * int numHoles          : number of cities/holes to be generated
     * double ub             : the upper bound on the random value to be generated (minimum is 1.0)
+    * uint64_t seed         : seed of the board (0: time-based)
+    * threadPool* pool      : workers filling the rows (nullptr: calling thread only)
      * */
-    times.resize(numHoles);
-    for(int i = 0; i < numHoles; i++)
-        times[i].resize(numHoles);
-    std::random_device rng;
-    std::mt19937 gen(rng());
-    std::uniform_real_distribution<> distribution(1.0, ub);
-    for (int i = 0; i < numHoles; i++) {
-        for (int j = i; j < numHoles; j++){
-            if (i == j)
-                times[i][j] = 0.0;
-            else {
-                double t = distribution(gen);
-                times[i][j] = t;
-                times[j][i] = t;
+    times.resize(numHoles, numHoles);
+    seed = boardSeed(seed);
+    // Row i draws the edges (i, j > i) from stream i, and mirrors them: no other row writes them
+    forRows(numHoles, pool, [&times, numHoles, ub, seed](int first, int last, unsigned) {
+        for (int i = first; i < last; i++) {
+            rngStream rng(seed, static_cast<uint64_t>(i));
+            for (int j = i; j < numHoles; j++){
+                if (i == j)
+                    times[i][j] = 0.0;
+                else {
+                    double t = 1.0 + (ub - 1.0) * rng.nextDouble();
+                    times[i][j] = t;
+                    times[j][i] = t;
+                }
             }
         }
-    }
+    });
 }
 
 void boardGenerator::findHolesPerSide(int& numHoles, int& holesPerSide, int informativeness) {
@@ -85,6 +126,26 @@ void boardGenerator::findHolesPerSide(int& numHoles, int& holesPerSide, int info
         std::cout << numHoles << ") ..." << std::endl;
 }
 
+template <int MODE>
+static void fillTimes(doubleMap &times, const std::deque<std::pair<double,double>>& coordMat, threadPool* pool) {
+    /*
+     * Distances, a block of whole rows at a time (see generateTimes). Rows are written contiguously and by a single
+     * worker; d(j, i) is computed again rather than mirrored, and is the same bit for bit (|dx| and dx*dx do not
+     * depend on the sign of dx).
+     */
+    int numHoles = static_cast<int>(coordMat.size());
+    forRows(numHoles, pool, [&times, &coordMat, numHoles](int first, int last, unsigned) {
+        for (int i = first; i < last; i++) {
+            // Iterate neighbor of holes
+            for (int j = 0; j < numHoles; j++) {
+                // This will not be selected regardless at solve time
+                times[i][j] = (i == j) ? 0.0 : distanceProvider::metric<MODE>(coordMat[i].first, coordMat[i].second,
+                                                                              coordMat[j].first, coordMat[j].second);
+            }
+        }
+    });
+}
+
 double boardGenerator::findDistance(int distMode, std::pair<double, double> h1, std::pair<double, double> h2){
     /**
     * Find distance between two coordinate points
@@ -98,9 +159,9 @@ double boardGenerator::findDistance(int distMode, std::pair<double, double> h1,
     try {
         switch (distMode) {
             case MANHATTAN:
-                return Utils::manhattanDistance(h1, h2);
+                return distanceProvider::metric<MANHATTAN>(h1.first, h1.second, h2.first, h2.second);
             case EUCLIDEAN:
-                return Utils::euclideanDistance(h1, h2);
+                return distanceProvider::metric<EUCLIDEAN>(h1.first, h1.second, h2.first, h2.second);
             default:
                 throw std::runtime_error(std::string(__FILE__) + ": "
                                          + "Unrecognized distance identifier.");
@@ -112,67 +173,70 @@ double boardGenerator::findDistance(int distMode, std::pair<double, double> h1,
     }
 }
 
-void boardGenerator::generateTimes(doubleMap &times, std::deque<std::pair<double,double>>& coordMat,  int distMode){
+bool boardGenerator::generateTimes(doubleMap &times, std::deque<std::pair<double,double>>& coordMat,  int distMode,
+                                   threadPool* pool){
     /**
-    * Generate a matrix (vector of vectors) of times (aka distances) given a list of coordinates representing
+    * Generate a matrix of times (aka distances) given a list of coordinates representing
     * holes on the board. Generated distances are stored in the times doubleMap.
+    * The metric is chosen once: each pair is measured by a loop specialised on it.
     * -- Parameters --
-    * doubleMap &times                                  : Matrix (vector of vectors) of distances/times to be filled
+    * doubleMap &times                                  : Matrix of distances/times to be filled
     * std::deque<std::pair<double,double>>& coordMat    : double ended queue containing coordinates of points
     * int distMode                                      : distance function to use
+    * threadPool* pool                                  : workers filling the rows (nullptr: calling thread only)
+    * -- Return --
+    * Whether the matrix was filled (false if the distance function is unknown)
     * */
     // --- Allocation ---
-    times.resize(coordMat.size());
-    for (int i = 0; i < coordMat.size(); i++)
-        times[i].resize(coordMat.size());
+    times.resize(coordMat.size(), coordMat.size());
     // --- Generation ---
-    for (int i = 0; i < coordMat.size(); i++) {
-        // Iterate neighbor of holes
-        for (int j = i; j < coordMat.size(); j++) {
-            // This will not be selected regardless at solve time
-            if (i==j)
-                times[i][j] = 0.0;
-            else {
-                double t = findDistance(distMode, coordMat[i], coordMat[j]);
-                times[i][j] = t;
-                times[j][i] = t;
-            }
+    try {
+        switch (distMode) {
+            case MANHATTAN:
+                fillTimes<MANHATTAN>(times, coordMat, pool);
+                break;
+            case EUCLIDEAN:
+                fillTimes<EUCLIDEAN>(times, coordMat, pool);
+                break;
+            default:
+                throw std::runtime_error(std::string(__FILE__) + ": "
+                                         + "Unrecognized distance identifier.");
         }
+    } catch(std::exception& e)
+    {
+        std::cout << ">>>EXCEPTION: " << e.what() << std::endl;
+        return false;
     }
-    // Comment this line to remove saving of instances
-    Utils::saveToDAT(times);
+    return true;
 }
 
-void boardGenerator::randomGrid(doubleMap &times, int holesPerSide, double interval, int originalNum, int distMode, int informativeness) {
+void boardGenerator::randomGrid(doubleMap &times, int holesPerSide, double interval, int originalNum, int distMode,
+                                int informativeness, uint64_t seed, threadPool* pool, bool save) {
     /**
     * Generate a random grid, where holes are punched with p=0.5 until "originalNum" holes are created.
     * Could be vastly more efficient...
     * -- Parameters --
-    * doubleMap &times          : Matrix (vector of vectors) of distances/times to be filled
+    * doubleMap &times          : Matrix of distances/times to be filled
     * int holesPerSide          : calculated number of holes per side in the cointoss grid
     * double interval           : minimum horizontal/vertical distance between holes
     * int originalNum           : exact number of holes that should appear
     * int distMode              : distance function to use
     * int informativeness       : specifies how informative output messages should be
-
+    * uint64_t seed             : seed of the board (0: time-based)
+    * threadPool* pool          : workers computing the distances (nullptr: calling thread only)
+    * bool save                 : save the coordinates and the distances (see saveBoard)
     * */
     // Linearized "matrix"
     std::deque<std::pair<double,double>> coordMat;
     // --- Toss a coin to decide whether hole should appear or not ---
-    std::mt19937_64 rng;
-    // initialize the random number generator with time-dependent seed
-    uint64_t timeSeed = std::chrono::high_resolution_clock::now().time_since_epoch().count();
-    std::seed_seq ss{uint32_t(timeSeed & 0xffffffff), uint32_t(timeSeed>>32)};
-    rng.seed(ss);
-    // initialize a uniform distribution between 0 and 1
-    std::uniform_real_distribution<double> p(0, 1);
+    rngStream rng(boardSeed(seed), 0);
     // --- Generate evenly spread coordinates on a grid ---
     // Keep generating until correct size
     while(coordMat.size() != originalNum) {
         for (int i = 0; i < holesPerSide; i++) {
             for (int j = 0; j < holesPerSide; j++) {
                 // Simulates going through row/columns and picking whether the hole is made
-                if (p(rng) > 0.5) {
+                if (rng.nextDouble() > 0.5) {
                     std::pair<double, double> coord;
                     coord.first = j * interval + interval / 2;
                     coord.second = i * interval + interval / 2;
@@ -184,29 +248,31 @@ void boardGenerator::randomGrid(doubleMap &times, int holesPerSide, double inter
             coordMat.clear();
     }
 
-    // Comment this line to remove saving of coordinates
-    Utils::saveCoordsToCSV(coordMat, originalNum);
-
     if (informativeness != SILENT)
         std::cout << "Generated a board with: " << coordMat.size() << " holes." << std::endl;
     // --- Populate distance map ---
 
-    generateTimes(times, coordMat, distMode);
+    // Comment the saving to keep coordinates and instances in memory only
+    if (generateTimes(times, coordMat, distMode, pool) && save)
+        saveBoard(coordMat, originalNum, times);
 }
 
 
 
-void boardGenerator::generateCoinTossGridBoard(doubleMap& times, int numHoles, int distMode, int informativeness) {
+void boardGenerator::generateCoinTossGridBoard(doubleMap& times, int numHoles, int distMode, int informativeness,
+                                               uint64_t seed, threadPool* pool, bool save) {
     /**
     * Generate the parameters and fill the cointoss grid board.
     * A "cointoss" grid is a board where numHoles appear at regular intervals. To make it so the board
     * is slightly different each time, some holes are skipped (a coin is tossed to decide whether it appears or not)
     * -- Parameters --
-    * doubleMap &times          : Matrix (vector of vectors) of distances/times to be filled
+    * doubleMap &times          : Matrix of distances/times to be filled
     * int numHoles              : exact number of holes that should appear
     * int distMode              : distance function to use
     * int informativeness       : specifies how informative output messages should be
-
+    * uint64_t seed             : seed of the board (0: time-based)
+    * threadPool* pool          : workers computing the distances (nullptr: calling thread only)
+    * bool save                 : save the coordinates and the distances (see saveBoard)
     * */
     try {
         // --- "Gridify" ---
@@ -223,7 +289,7 @@ void boardGenerator::generateCoinTossGridBoard(doubleMap& times, int numHoles, i
                                      + "Too many holes! Please try a smaller number");
 
         // --- Generation of times ---
-        randomGrid(times, holesPerSide, interval, originalNum, distMode, informativeness);
+        randomGrid(times, holesPerSide, interval, originalNum, distMode, informativeness, seed, pool, save);
 
 
     } catch(std::exception& e)
@@ -296,13 +362,17 @@ int boardGenerator::findBlock(std::deque<block>& supportVec, std::deque<std::pai
     return idx-1;                       // Retrieve index for coords
 }
 
-void boardGenerator::generateGeometricBoard(doubleMap& times, int numHoles, int distMode){
+void boardGenerator::generateGeometricBoard(doubleMap& times, int numHoles, int distMode, uint64_t seed,
+                                            threadPool* pool, bool save){
     /**
     * Generate a "geometric board", aka a board filled with holes in regular polygon shapes.
     * -- Parameters --
-    * doubleMap &times          : Matrix (vector of vectors) of distances/times to be filled
+    * doubleMap &times          : Matrix of distances/times to be filled
     * int numHoles              : exact number of holes that should appear
     * int distMode              : distance function to use
+    * uint64_t seed             : seed of the board (0: time-based)
+    * threadPool* pool          : workers computing the distances (nullptr: calling thread only)
+    * bool save                 : save the coordinates and the distances (see saveBoard)
     * */
     try {
         // --- Initialization ---
@@ -312,6 +382,7 @@ void boardGenerator::generateGeometricBoard(doubleMap& times, int numHoles, int
                                      + "Invalid number of holes; at least 3 holes required for geometric generation.");
         std::deque<std::pair<double, double>> coordMat;
         std::deque<block> supportVec;
+        rngStream rng(boardSeed(seed), 0);
         // Initial split into 4 squares
         splitBoard(supportVec, std::make_pair(SIDE/2, SIDE/2), SIDE);
 
@@ -321,23 +392,23 @@ void boardGenerator::generateGeometricBoard(doubleMap& times, int numHoles, int
             // --- Action decided based on how many holes remain to be punched
             switch(available){
                 case 1:
-                    figureGenerator::addFillerHoles(coordMat, 1);
+                    figureGenerator::addFillerHoles(coordMat, 1, rng);
                     generatedHoles+=1;
                     break;
                 case 2:
-                    figureGenerator::addFillerHoles(coordMat, 2);
+                    figureGenerator::addFillerHoles(coordMat, 2, rng);
                     generatedHoles+=2;
                     break;
                 default:
                     // --- Select the first free, largest block (or split one to create free space) ---
                     figureGenerator::addRandomFigure(coordMat, findBlock(supportVec, coordMat, generatedHoles),
-                            supportVec, generatedHoles, available);
+                            supportVec, generatedHoles, available, rng);
                     break;
             }
         }  while(generatedHoles != numHoles);
-        // Comment this line to remove saving of coordinates
-        Utils::saveCoordsToCSV(coordMat, numHoles);
-        generateTimes(times, coordMat, distMode);
+        // Comment the saving to keep coordinates and instances in memory only
+        if (generateTimes(times, coordMat, distMode, pool) && save)
+            saveBoard(coordMat, numHoles, times);
 
     } catch(std::exception& e)
     {
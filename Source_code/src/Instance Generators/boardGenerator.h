@@ -1,32 +1,51 @@
 #ifndef BOARDGENERATOR_H
 #define BOARDGENERATOR_H
 #include "figureGenerator.h"
+#include "../Utilities/threadPool.h"
+#include <cstdint>
 
 /**
  * @file boardGenerator.h/cpp
  * @brief Handles generation of boards of various kinds.
  */
 
+/*
+ * Every board is drawn from its own seed (0: time-based), so that boards generated concurrently are the same as
+ * boards generated one after the other. A pool, if given, fills the rows of the distance matrix in blocks: the
+ * board does not depend on the number of threads either.
+ * Geometric boards (cointoss, polygons) may be saved: coordinates to coordinates_<n>.csv and distances to the .dat file
+ * of size n, both at once. Files only depend on the size: when several boards of a size are generated, only one of
+ * them should be saved (solverManager saves the last one), or the surviving files depend on the timing of the threads.
+ */
+
 class boardGenerator {
 private:
     static void findHolesPerSide(int& numHoles, int& holesPerSide, int informativeness);
-    static void randomGrid(doubleMap& times, int holesPerSide, double interval, int originalNum, int distMode, int informativeness );
+    static void randomGrid(doubleMap& times, int holesPerSide, double interval, int originalNum, int distMode,
+                           int informativeness, uint64_t seed, threadPool* pool, bool save);
     static void splitBoard(std::deque<block>& supportVec, std::pair<double, double> c, double side);
     static int findBlock(std::deque<block>& supportVec, std::deque<std::pair<double, double>>& coordMat, int& generated);
     static void deleteFirstBlock(std::deque<block>& supportVec, std::deque<std::pair<double, double>>& coordMat, int &generated);
+    static uint64_t boardSeed(uint64_t seed);
+    static void saveBoard(std::deque<std::pair<double, double>>& coordMat, int numHoles, doubleMap& times);
 public:
     boardGenerator()= default;
     static double findDistance(int distMode, std::pair<double, double> h1, std::pair<double, double> h2);
     // Generates random times between holes. Times are asymmetric.
-    static void generateAsymBoard(doubleMap& times, int numHoles, double ub);
+    static void generateAsymBoard(doubleMap& times, int numHoles, double ub, uint64_t seed = 0,
+                                  threadPool* pool = nullptr);
     // Generate random board. Times are random, but symmetric (NOTE: might not satisfy triangle inequality!).
-    static void generateSymBoard(doubleMap& times, int numHoles, double ub);
+    static void generateSymBoard(doubleMap& times, int numHoles, double ub, uint64_t seed = 0,
+                                 threadPool* pool = nullptr);
     // Generate a board with holes on a grid. Holes appear with p=0.5.
-    static void generateCoinTossGridBoard(doubleMap& times, int numHoles, int distMode, int informativeness);
+    static void generateCoinTossGridBoard(doubleMap& times, int numHoles, int distMode, int informativeness,
+                                          uint64_t seed = 0, threadPool* pool = nullptr, bool save = true);
     // Generated holes at random on the board, as vertices of geometric figures (no intersection).
-    static void generateGeometricBoard(doubleMap& times, int numHoles, int distMode);
-    // Transform a deque of coordinates into a matrix of times
-    static void generateTimes(doubleMap &times, std::deque<std::pair<double,double>>& coordMat,  int distMode);
+    static void generateGeometricBoard(doubleMap& times, int numHoles, int distMode, uint64_t seed = 0,
+                                       threadPool* pool = nullptr, bool save = true);
+    // Transform a deque of coordinates into a matrix of times (false if the metric is unknown)
+    static bool generateTimes(doubleMap &times, std::deque<std::pair<double,double>>& coordMat,  int distMode,
+                              threadPool* pool = nullptr);
 };
 
 
@@ -1,7 +1,6 @@
 #include "figureGenerator.h"
 #include "../Utilities/utils.h"
 #include <vector>
-#include <random>
 #include <utility>
 #include <tuple>
 #include <fstream>
@@ -12,7 +11,8 @@
  */
 
 void figureGenerator::addRandomFigure(std::deque<std::pair<double,double>>& coordMat, int  blockIdx,
-                                      std::deque<block>& supportVec, int& generatedHoles, int availableHoles){
+                                      std::deque<block>& supportVec, int& generatedHoles, int availableHoles,
+                                      rngStream& rng){
     /**
     * Add a random figure with a random value of vertices (between 3 and MAX_POLY_SIZE, or the number of available holes
     * if it exceeds MAX_POLY_SIZE)
@@ -22,16 +22,14 @@ void figureGenerator::addRandomFigure(std::deque<std::pair<double,double>>& coor
     * std::deque<block>& supportVec                         : Double ended queue containing the "block" structures
     * int& generatedHoles                                   : number of holes generated so far
     * int availableHoles                                    : holes still available (before reaching the requested amount)
+    * rngStream& rng                                        : random stream of the board
     * */
-    std::random_device rng;
-    std::mt19937 gen(rng());
     // Restrict choices based on how many holes are available
     int max = (availableHoles <= MAX_POLY_SIZE) ? availableHoles : MAX_POLY_SIZE;
 
-    std::uniform_int_distribution<> distr(3, max);
-    int numVerts = distr(gen);
-    std::uniform_int_distribution<> distr2(1, 90); // Generate a random inclination
-    generatePolygon(numVerts, supportVec[blockIdx].side/POLY_RADIUS_RATIO, (distr2(gen)* M_PI) / 180,
+    int numVerts = 3 + rng.nextInt(max - 2);
+    int inclination = 1 + rng.nextInt(90); // Generate a random inclination (degrees)
+    generatePolygon(numVerts, supportVec[blockIdx].side/POLY_RADIUS_RATIO, (inclination * M_PI) / 180,
             coordMat, supportVec[blockIdx]);
     generatedHoles+=numVerts;
 
@@ -56,16 +54,16 @@ void figureGenerator::generatePolygon(int numVertices, double radius, double the
 }
 
 
-void figureGenerator::addFillerHoles(std::deque<std::pair<double,double>>& coordMat, int num){
+void figureGenerator::addFillerHoles(std::deque<std::pair<double,double>>& coordMat, int num, rngStream& rng){
     /**
     * Add "filler holes" to the board (1 or 2, since at least 3 are require for a polygon)
     * -- Parameters --
     * std::deque<std::pair<double,double>>& coordMat    : double ended queue containing coordinates of points
     * int num                                           : number of filler points to add
+    * rngStream& rng                                    : random stream of the board
     * */
     try{
         std::pair<double,double> coord;
-        Utils ut;
         switch(num) {
             case 1:
                 // Add a hole in the middle
@@ -74,7 +72,7 @@ void figureGenerator::addFillerHoles(std::deque<std::pair<double,double>>& coord
                 coordMat.emplace_back(coord);
                 break;
             case 2:
-                if (ut.generateRngZeroOne() > 0.5){
+                if (rng.nextDouble() > 0.5){
                     // Add holes in a "diagonal"
                     coord.first = SIDE / 4;
                     coord.second = SIDE / 4;
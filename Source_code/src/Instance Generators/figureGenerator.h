@@ -9,6 +9,7 @@
 #include <iostream>
 #include <deque>
 #include "../Utilities/typesAndDefs.h"
+#include "../Utilities/rng.h"
 
 // Simple structure to represent a block (small square area of the grid)
 class block{
@@ -26,8 +27,8 @@ public:
     static void generatePolygon(int numVertices, double radius, double theta,
                 std::deque<std::pair<double,double>>& coordMat, block& currentBlock);
     static void addRandomFigure(std::deque<std::pair<double,double>>& coordMat, int blockIdx,
-                                std::deque<block>& supportVec, int& generatedHoles, int availableHoles);
-    static void addFillerHoles(std::deque<std::pair<double,double>>& coordMat, int num);
+                                std::deque<block>& supportVec, int& generatedHoles, int availableHoles, rngStream& rng);
+    static void addFillerHoles(std::deque<std::pair<double,double>>& coordMat, int num, rngStream& rng);
 
 };
 
@@ -3,9 +3,8 @@
 #include <iostream>
 #include <chrono>
 #include <iomanip>
-#include <random>
-#include <future>
-#include <thread>
+#include <algorithm>
+#include <mutex>
 
 /**
  * @file ACSHeuristic.h/cpp
@@ -16,18 +15,28 @@ void ACSHeuristic::init() {
     /**
     * Initialize the necessary variables
     * */
-    pheromones.resize(numHoles);                    // Pheromone values
-    deltaPheromones.resize(numHoles);               // Pheromone variation
+    // Random streams: the colony and every ant get their own stream, all derived from the run seed.
+    // With a fixed master seed, every run (and its results) can be reproduced regardless of threads.
+    uint64_t master = (seed != 0) ? seed
+                      : static_cast<uint64_t>(std::chrono::high_resolution_clock::now().time_since_epoch().count());
+    runSeed = rngStream(master, runCount).next();
+    rng.seed(runSeed, 0);
+    pheromones.resize(numHoles, numHoles);          // Pheromone values
+    deltaPheromones.resize(numHoles, numHoles);     // Pheromone variation
+    choiceInfo.resize(numHoles, numHoles);          // Weights of the state transition rule
     probs.resize(numHoles);                         // Probability vector <p, hole_index> (filled from a specific hole)
     bestRoute.resize(numHoles);                     // Best path so far
+    bestLen = static_cast<double>(INT_MAX);         // (each run starts from scratch)
+    pheromoneScale = 1.0;                           // Global evaporation not applied yet
+    renormalizeBelow = pow(PHEROMONE_RENORMALIZATION, 1 / std::max(alpha, 1.0));
+    double startingWeight = pow(T_0, alpha);        // Same trail on every edge
     for(int i=0; i<numHoles; i++){
-        pheromones[i].resize(numHoles);
-        deltaPheromones[i].resize(numHoles);
         probs[i] = std::make_pair(-1.0, -1.0);
 
         for (int j=0; j<numHoles; j++){
             pheromones[i][j]        = T_0;
             deltaPheromones[i][j]   = 0.0;
+            choiceInfo[i][j]        = startingWeight * heuristicInfo[i][j];
         }
     }
     // Ants
@@ -35,25 +44,135 @@ void ACSHeuristic::init() {
     antColony.resize(numAnts);                      // Vector of ants that will perform optimization
     for(int i=0; i<numAnts; i++){
         routes[i].resize(numHoles);
-        antColony[i].init(i, numHoles, &bestLen, &bestRoute, &pheromones,
-                                    &deltaPheromones, *distances, &ut, alpha,
-                                    beta, local_evaporation_rate, q_0);
+        antColony[i].init(i, numHoles, &pheromones, &pheromoneScale, &deltaPheromones, &choiceInfo, &heuristicInfo, &distances,
+                                    (candidates.empty() ? nullptr : &candidates),
+                                    runSeed,
+                                    // Asynchronous ants update the trails as in relaxed mode
+                                    (localUpdateMode == LOCAL_UPDATE_ASYNCHRONOUS) ? LOCAL_UPDATE_RELAXED : localUpdateMode,
+                                    (localSearchScope == LOCAL_SEARCH_EVERY_ANT) ? localSearchMode : LOCAL_SEARCH_NONE,
+                                    neighbours, alpha, beta, local_evaporation_rate, q_0, vectorKernels);
         for (int j=0; j<numHoles; j++)
             routes[i][j] = -1;
     }
 }
 
+void ACSHeuristic::buildCandidateLists() {
+    /**
+    * Build the candidate list of each hole: the indices of its candidateListSize nearest holes,
+    * sorted by increasing distance. The local search (and chained LK) uses the same lists (or LOCAL_SEARCH_NEIGHBOURS
+    * nearest holes, if candidate lists are disabled). Lists only depend on the instance, so they survive reset().
+    * */
+    candidates.clear();
+    neighbourLists.clear();
+    neighbours = nullptr;
+    if (numHoles < 2) {
+        localSearchMode = LOCAL_SEARCH_NONE;
+        kicks = 0;
+        return;
+    }
+    if (candidateListSize > 0)
+        localSearch::nearestHoles(distances, candidateListSize, candidates, pool);
+    if (localSearchMode == LOCAL_SEARCH_NONE && kicks <= 0)
+        return;
+    // Local search moves reverse parts of the tour: they are only valid with symmetric distances
+    if (!distances.symmetric()) {
+        std::cout << "Local search disabled: distances are not symmetric." << std::endl;
+        localSearchMode = LOCAL_SEARCH_NONE;
+        kicks = 0;
+        return;
+    }
+    if (candidates.empty()) {
+        localSearch::nearestHoles(distances, LOCAL_SEARCH_NEIGHBOURS, neighbourLists, pool);
+        neighbours = &neighbourLists;
+    } else
+        neighbours = &candidates;
+    improver.init(numHoles, &distances, neighbours);
+}
+
+void ACSHeuristic::buildHeuristicInfo() {
+    /**
+    * Compute the heuristic part of the state transition rule, eta^beta (with eta = 1/distance), for every edge.
+    * It only depends on the instance, so it is computed once and survives reset().
+    * */
+    heuristicInfo.resize(numHoles, numHoles);
+    withExponent(exponentId(beta), [this](auto b) {
+        for (int i=0; i<numHoles; i++){
+            for (int j=0; j<numHoles; j++)
+                // An ant never moves from a hole to itself
+                heuristicInfo[i][j] = (i == j) ? 0.0 : power<decltype(b)::value>::of(1 / distances(i, j), beta);
+        }
+    });
+}
+
 void ACSHeuristic::reset() {
     /* Reset current values */
+    reset(runCount + 1);
+}
+
+void ACSHeuristic::reset(unsigned run) {
+    /**
+    * Reset current values, and derive the random streams of the given run: with a fixed master seed, run r gives
+    * the same results whether it follows r calls to reset() or is started directly (e.g. on another thread)
+    * -- Parameters --
+    * unsigned run  : run number (0: first run, as after construction)
+    * */
     pheromones.clear();
     deltaPheromones.clear();
+    choiceInfo.clear();
     probs.clear();
     bestRoute.clear();
     routes.clear();
     antColony.clear();
+    runCount = run;
     init();
 }
 
+void ACSHeuristic::setThreads(unsigned numThreads) {
+    /**
+    * -- Parameters --
+    * unsigned numThreads   : number of threads running the ants, caller included (0: one per hardware core)
+    * */
+    ownPool = std::make_unique<threadPool>(numThreads);
+    pool = ownPool.get();
+    concurrent = pool->size() > 1;
+}
+
+void ACSHeuristic::shareThreads(threadPool* shared) {
+    /**
+    * -- Parameters --
+    * threadPool* shared    : workers owned by the caller, who must not run a parallel loop on them meanwhile
+    * */
+    pool = shared;
+    ownPool.reset();
+    concurrent = pool->size() > 1;
+}
+
+void ACSHeuristic::joinIslands(islandMailbox* _mailbox, int _island, int _interval) {
+    /**
+    * -- Parameters --
+    * islandMailbox* _mailbox   : mailbox shared by all the islands (owned by the caller)
+    * int _island               : index of this colony among them
+    * int _interval             : iterations between two migrations
+    * */
+    mailbox = _mailbox;
+    island = _island;
+    migrationInterval = std::max(1, _interval);
+}
+
+void ACSHeuristic::migrate() {
+    /*
+     * Ring migration: publish the best tour so far, and take the one of the previous island if it is shorter.
+     * The global update right after reinforces it, so the immigrant steers the trails of this colony.
+     * */
+    mailbox->publish(island, bestRoute, bestLen);
+    double length;
+    int from = (island + mailbox->size() - 1) % mailbox->size();
+    if (from != island && mailbox->fetch(from, immigrant, length) && length < bestLen) {
+        bestLen = length;
+        bestRoute.swap(immigrant);
+    }
+}
+
 void ACSHeuristic::printSpecifics(){
     /**
     * Print the specifics being run
@@ -61,8 +180,33 @@ void ACSHeuristic::printSpecifics(){
     std::cout << "-- Parameters --" << std::endl;
     std::cout << "    Number of ants           :      " << numAnts << std::endl;
     std::cout << "    Number of holes          :      " << numHoles << std::endl;
-    std::cout << "    Number of iterations     :      " << iterations << std::endl;
-    std::cout << "    Concurrency enabled      :      " << ((concurrent) ? "Yes" : "No") << std::endl;
+    std::cout << "    Stopping criteria        :      ";
+    stop.print();
+    std::cout << std::endl;
+    std::cout << "    Concurrency enabled      :      " << ((concurrent) ? "Yes" : "No")
+              << " (" << pool->size() << " thread(s))" << std::endl;
+    std::cout << "    Local update mode        :      "
+              << ((localUpdateMode == LOCAL_UPDATE_RELAXED) ? "Relaxed"
+                  : (localUpdateMode == LOCAL_UPDATE_DEFERRED) ? "Deferred"
+                  : (localUpdateMode == LOCAL_UPDATE_ASYNCHRONOUS) ? "Asynchronous" : "Deterministic") << std::endl;
+    std::cout << "    Candidate list size      :      "
+              << ((candidates.empty()) ? "All holes" : std::to_string(candidates[0].size())) << std::endl;
+    std::cout << "    Vector kernels           :      " << antKernels::select(vectorKernels).name
+              << ((localUpdateMode == LOCAL_UPDATE_RELAXED || localUpdateMode == LOCAL_UPDATE_ASYNCHRONOUS)
+                  ? " (roulette search only: shared rows are read one weight at a time)" : "") << std::endl;
+    std::string operators;
+    if (localSearchMode & LOCAL_SEARCH_2OPT)
+        operators += "2-opt ";
+    if (localSearchMode & LOCAL_SEARCH_OROPT)
+        operators += "Or-opt ";
+    if (localSearchMode & LOCAL_SEARCH_LK)
+        operators += "LK ";
+    std::cout << "    Local search             :      "
+              << ((operators.empty()) ? "None"
+                  : operators + ((localSearchScope == LOCAL_SEARCH_EVERY_ANT) ? "(every ant)" : "(iteration best)"))
+              << std::endl;
+    std::cout << "    Chained LK on best tour  :      "
+              << ((kicks > 0) ? std::to_string(kicks) + " kicks" : "No") << std::endl;
     std::cout << "    Misc parameters..." << "\n    | Alpha: " <<  alpha << " | Beta: "
                 << beta << " | Local e.r. : " << local_evaporation_rate
                 << " | Global e.r. : "  << global_evaporation_rate << " |\n    | Starting trail : "
@@ -93,7 +237,7 @@ void ACSHeuristic::printPheromones() {
                 printf("%5s   ", "~");
                 continue;
             }
-            printf("%7.3f ", pheromones[i][j]);
+            printf("%7.3f ", pheromoneScale * pheromones[i][j]);
         }
         std::cout << std::endl;
     }
@@ -133,7 +277,8 @@ void ACSHeuristic::printResults() {
     for (auto hole : bestRoute)
         std::cout << hole << " ";
     std::cout << "\n    Number of ants        :      " << numAnts << std::endl;
-    std::cout << "    Number of iterations  :      " << iterations << std::endl;
+    std::cout << "    Number of iterations  :      " << stop.iterationsRun() << std::endl;
+    std::cout << "    Stopped by            :      " << stoppingRule::describe(stop.reason()) << std::endl;
     std::cout << "    Found obj             :      " << bestLen << std::endl;
     if (optimalSolution != -1) {
         std::cout << "    Optimal obj           :      " << optimalSolution << std::endl;
@@ -173,79 +318,257 @@ void ACSHeuristic::printResults() {
 //    }
 //}
 
-bool ACSHeuristic::isBest(int i, int j){
+void ACSHeuristic::globalPheromoneUpdate() {
     /*
-    * Check if two holes belong to the best route
-    * -- Parameters --
-    * int i :   outgoing hole
-    * int j :   incoming hole
-    * -- Return --
-    * True if the edge i-j belongs to the current best tour, false otherwise
-    */
-    for (int x=0; x<numHoles-1; x++) {
-        if (i == bestRoute[i] && j == bestRoute[i+1])
-            return true;
-    }
-    return false;
+     * Update pheromones globally: all trails decay, and the edges of the best tour so far receive
+     * the reciprocal of its length.
+     * Decay is lazy: trails are stored divided by pheromoneScale, so evaporating every edge only means
+     * shrinking the scale, and depositing on an edge means adding deposit/scale to it. The update is
+     * therefore O(numHoles) rather than O(numHoles^2).
+     * choiceInfo holds stored^alpha * eta^beta, i.e. the actual weights divided by scale^alpha: a common
+     * factor that changes neither the probabilities nor the greedy choice, so only best edges are refreshed.
+     * */
+    pheromoneScale *= (1 - global_evaporation_rate);
+    double deposit = global_evaporation_rate * (1 / bestLen) / pheromoneScale;
+    withExponent(exponentId(alpha), [this, deposit](auto a) {
+        for (int r=0; r<numHoles; r++){
+            int i = bestRoute[r];
+            int j = bestRoute[(r + 1) % numHoles];
+            pheromones[i][j] += deposit;
+            pheromones[j][i] += deposit;
+            choiceInfo[i][j] = power<decltype(a)::value>::of(pheromones[i][j], alpha) * heuristicInfo[i][j];
+            choiceInfo[j][i] = power<decltype(a)::value>::of(pheromones[j][i], alpha) * heuristicInfo[j][i];
+        }
+    });
+    // Keep stored values (and their powers) far from overflow
+    if (pheromoneScale < renormalizeBelow)
+        renormalizePheromones();
 }
 
-void ACSHeuristic::globalPheromoneUpdate() {
+void ACSHeuristic::globalUpdateOnBestEdges() {
     /*
-     * Update pheromones globally, only on best edges.
-     * The global update of pheromones is the reciprocal of the best length so far
+     * Global update of the original ACS: only the edges of the best tour so far evaporate and receive the
+     * reciprocal of its length. Used by the asynchronous mode, where ants keep running during the update: it
+     * touches O(numHoles) trails (through relaxed atomics, like local updates) and never changes the
+     * evaporation scale.
      * */
-    for(int i=0; i<numHoles; i++){
-        for(int j=0; j<numHoles; j++){
-            if (i==j)
-                continue;
-            // All pheromone trails decay
-            pheromones[i][j] = (1 - global_evaporation_rate) * pheromones[i][j];
-            pheromones[j][i] = (1 - global_evaporation_rate) * pheromones[j][i];
-            // If the edge belongs to the best path, also increase the pheromone level
-            if(isBest(i,j)){
-                pheromones[i][j] += global_evaporation_rate * (1 / bestLen);
-                pheromones[j][i] += global_evaporation_rate * (1 / bestLen);
+    double deposit = global_evaporation_rate * (1 / bestLen) / pheromoneScale;
+    withExponent(exponentId(alpha), [this, deposit](auto a) {
+        for (int r=0; r<numHoles; r++){
+            int i = bestRoute[r];
+            int j = bestRoute[(r + 1) % numHoles];
+            for (auto edge : {std::make_pair(i, j), std::make_pair(j, i)}) {
+                double& trail = pheromones[edge.first][edge.second];
+                double updated = (1 - global_evaporation_rate) * loadShared(trail) + deposit;
+                storeShared(trail, updated);
+                storeShared(choiceInfo[edge.first][edge.second],
+                            power<decltype(a)::value>::of(updated, alpha) * heuristicInfo[edge.first][edge.second]);
+            }
+        }
+    });
+}
+
+void ACSHeuristic::renormalizePheromones() {
+    /*
+     * Multiply every stored trail by the evaporation scale and reset the scale to 1. O(numHoles^2), but only
+     * needed once every log(renormalizeBelow)/log(1 - global_evaporation_rate) iterations.
+     * */
+    withExponent(exponentId(alpha), [this](auto a) {
+        for (int i=0; i<numHoles; i++){
+            for (int j=0; j<numHoles; j++){
+                pheromones[i][j] *= pheromoneScale;
+                choiceInfo[i][j] = power<decltype(a)::value>::of(pheromones[i][j], alpha) * heuristicInfo[i][j];
             }
         }
+    });
+    pheromoneScale = 1.0;
+}
+
+void ACSHeuristic::updateBest(const workerBestList& workerBests) {
+    /**
+    * Combine the per-worker bests into the iteration-best ant (ties go to the lowest ant index, so the
+    * result does not depend on how ants were split between workers), then update the best so far.
+    * -- Parameters --
+    * const workerBestList& workerBests         : best ant found by each worker in this iteration
+    * */
+    int iterationBest = -1;
+    double iterationLen = 0.0;
+    for (const auto& best : workerBests) {
+        if (best.ant == -1)
+            continue;
+        if (iterationBest == -1 || best.length < iterationLen
+            || (best.length == iterationLen && best.ant < iterationBest)) {
+            iterationLen = best.length;
+            iterationBest = best.ant;
+        }
+    }
+    // Only the iteration-best tour is improved, if local search is not applied by every ant
+    if (iterationBest != -1 && localSearchMode != LOCAL_SEARCH_NONE && localSearchScope == LOCAL_SEARCH_ITERATION_BEST)
+        iterationLen += improver.improve(routes[iterationBest], localSearchMode);
+    if (iterationBest != -1 && iterationLen < bestLen) {
+        bestLen = iterationLen;
+        bestRoute = routes[iterationBest];
     }
+}
+
+void ACSHeuristic::reduceChunk(int first, int last, workerBest& best) {
+    /**
+    * Fold the tours of ants [first, last) into the best ant seen by a worker
+    * -- Parameters --
+    * int first, int last   : range of ants (last excluded)
+    * workerBest& best      : slot of the worker that ran them
+    * */
+    for (int ant_k=first; ant_k < last; ant_k++) {
+        double len = antColony[ant_k].getTourLength();
+        if (best.ant == -1 || len < best.length || (len == best.length && ant_k < best.ant)) {
+            best.length = len;
+            best.ant = ant_k;
+        }
+    }
+}
 
+void ACSHeuristic::constructInLockStep(const std::vector<int>& startingHoles, workerBestList& workerBests) {
+    /**
+    * Deterministic construction: all ants take their i-th step in parallel, then the local updates of that
+    * step are applied in ant order. Ants see the updates of every previous step (as in the original,
+    * step-synchronous ACS), and the result does not depend on the number of threads.
+    * -- Parameters --
+    * const std::vector<int>& startingHoles     : starting hole of each ant
+    * workerBestList& workerBests               : per-worker iteration-best slots
+    * */
+    int antsPerChunk = pool->chunkFor(numAnts);
+    pool->parallelFor(numAnts, antsPerChunk, [this, &startingHoles](int first, int last, unsigned) {
+        for (int ant_k=first; ant_k < last; ant_k++)
+            antColony[ant_k].start(startingHoles[ant_k], &routes[ant_k]);
+    });
+    for (int i=0; i<numHoles-1; i++) {
+        pool->parallelFor(numAnts, antsPerChunk, [this, i](int first, int last, unsigned) {
+            for (int ant_k=first; ant_k < last; ant_k++)
+                antColony[ant_k].step(i);
+        });
+        for (int ant_k=0; ant_k < numAnts; ant_k++)
+            antColony[ant_k].localPheromoneUpdate(i);
+    }
+    pool->parallelFor(numAnts, antsPerChunk, [this, &workerBests](int first, int last, unsigned worker) {
+        for (int ant_k=first; ant_k < last; ant_k++)
+            antColony[ant_k].finish();
+        reduceChunk(first, last, workerBests[worker]);
+    });
+}
+
+void ACSHeuristic::mergeLocalUpdates() {
+    /**
+    * Deferred mode: apply the local updates of all the constructed routes of the iteration, then refresh the
+    * transition weights of the edges that were used, from the final trail values.
+    * */
+    int antsPerChunk = pool->chunkFor(numAnts);
+    pool->parallelFor(numAnts, antsPerChunk, [this](int first, int last, unsigned) {
+        for (int ant_k=first; ant_k < last; ant_k++)
+            antColony[ant_k].mergeLocalUpdates();
+    });
+    pool->parallelFor(numAnts, antsPerChunk, [this](int first, int last, unsigned) {
+        for (int ant_k=first; ant_k < last; ant_k++)
+            antColony[ant_k].refreshChoiceInfo();
+    });
+}
+
+void ACSHeuristic::checkStop(int it) {
+    /**
+    * -- Parameters --
+    * int it    : iteration just completed
+    * */
+    stop.update(it, bestLen);
+    // Islands: the first colony reaching the target stops all of them
+    if (mailbox != nullptr && stop.reason() == STOP_TARGET)
+        mailbox->finish();
+    else if (mailbox != nullptr && !stop.stopped() && mailbox->finished())
+        stop.halt(STOP_TARGET);
+}
+
+void ACSHeuristic::constructAsynchronously() {
+    /**
+    * Asynchronous mode: no iterations, hence no barrier. Every worker keeps sending out its own ants (ant k
+    * belongs to worker k % numWorkers), which update the trails as in relaxed mode. A tour shorter than the best
+    * so far is published at once and the publishing worker runs the global update, while the other workers
+    * keep building tours. Every numAnts tours (a round, the counterpart of an iteration) the global update runs
+    * again and the stopping criteria are checked. Only publications take a lock (they are rare), and results
+    * depend on the timing of the workers: runs are not reproducible.
+    * With the iteration-best scope, local search improves the tours about to be published.
+    * */
+    int numWorkers = std::min(static_cast<int>(pool->size()), numAnts);
+    std::mutex bestMutex;                   // Best tour, global updates, stopping criteria, local search
+    std::atomic<double> bestSnapshot(bestLen);
+    std::atomic<long> toursDone(0);
+    std::atomic<bool> finished(stop.stopped());
+    int rounds = 0;
+    pool->parallelFor(numWorkers, 1, [&](int worker, int, unsigned) {
+        // Streams 1 to numAnts belong to the ants
+        rngStream starts(runSeed, static_cast<uint64_t>(numAnts + 1 + worker));
+        for (int ant_k = worker; !finished.load(std::memory_order_relaxed);
+             ant_k = (ant_k + numWorkers < numAnts) ? ant_k + numWorkers : worker) {
+            antColony[ant_k].execute(starts.nextInt(numHoles), &routes[ant_k]);
+            double len = antColony[ant_k].getTourLength();
+            bool better = len < bestSnapshot.load(std::memory_order_relaxed);
+            bool roundOver = (toursDone.fetch_add(1, std::memory_order_relaxed) + 1) % numAnts == 0;
+            if (!better && !roundOver)
+                continue;
+            std::lock_guard<std::mutex> lock(bestMutex);
+            if (better && localSearchMode != LOCAL_SEARCH_NONE && localSearchScope == LOCAL_SEARCH_ITERATION_BEST)
+                len += improver.improve(routes[ant_k], localSearchMode);
+            if (better && len < bestLen) {
+                bestLen = len;
+                bestRoute = routes[ant_k];
+                globalUpdateOnBestEdges();
+            }
+            if (roundOver) {
+                if (mailbox != nullptr && (rounds + 1) % migrationInterval == 0)
+                    migrate();
+                globalUpdateOnBestEdges();
+                checkStop(rounds++);
+                if (stop.stopped())
+                    finished.store(true, std::memory_order_relaxed);
+            }
+            bestSnapshot.store(bestLen, std::memory_order_relaxed);
+        }
+    });
 }
 
 void ACSHeuristic::optimize() {
     /**
-    * Optimize problem with a given number of iterations
+    * Optimize problem until one of the stopping criteria is met (see stoppingRule)
     * */
-    // Enable/Disable concurrency
-    std::launch policy;
-    if (concurrent)
-        policy = std::launch::async;
-    else
-        policy = std::launch::deferred;
-    std::random_device rng;
-    std::mt19937 gen(rng());
-    std::uniform_int_distribution<> startingDistribution(0, numHoles - 1);
+    std::vector<int> startingHoles(numAnts);
+    // Ants are handed to the workers of the pool (single thread if concurrency is disabled) in chunks
+    int antsPerChunk = pool->chunkFor(numAnts);
+    workerBestList workerBests(pool->size());
 
     auto start = std::chrono::high_resolution_clock::now();
+    stop.start();
+    // Asynchronous mode runs until the stopping criteria are met: the iterations below are skipped
+    if (localUpdateMode == LOCAL_UPDATE_ASYNCHRONOUS)
+        constructAsynchronously();
     // -- Optimization --
-    for (int it=0; it<iterations; it++){
+    for (int it=0; !stop.stopped(); it++){
         // Send out each ant
-        // --- FUTURES ---
-        std::vector<std::future<void>> results;
-        results.reserve(numAnts);
         for (int ant_k=0; ant_k < numAnts; ant_k++)
-            results.emplace_back(std::async(policy, &Ant::execute, &antColony[ant_k],
-                    startingDistribution(gen), &routes[ant_k]));
-        for (auto & result : results)
-            result.get();
-        // --- THREADS ---
-//        std::vector<std::thread> threads;
-//        threads.reserve(numAnts);
-//        for (int ant_k=0; ant_k < numAnts; ant_k++)
-//            threads.emplace_back(&Ant::execute, &antColony[ant_k], startingDistribution(gen), &routes[ant_k]);
-//
-//        for (auto & thread : threads)
-//            thread.join();
-//        threads.clear();
+            startingHoles[ant_k] = rng.nextInt(numHoles);
+        for (auto& best : workerBests)
+            best.ant = -1;
+        if (localUpdateMode == LOCAL_UPDATE_DETERMINISTIC)
+            constructInLockStep(startingHoles, workerBests);
+        else
+            pool->parallelFor(numAnts, antsPerChunk,
+                              [this, &startingHoles, &workerBests](int first, int last, unsigned worker) {
+                for (int ant_k=first; ant_k < last; ant_k++)
+                    antColony[ant_k].execute(startingHoles[ant_k], &routes[ant_k]);
+                // Reduce the chunk into the worker's own slot
+                reduceChunk(first, last, workerBests[worker]);
+            });
+        if (localUpdateMode == LOCAL_UPDATE_DEFERRED)
+            mergeLocalUpdates();
+        updateBest(workerBests);
+        if (mailbox != nullptr && (it + 1) % migrationInterval == 0)
+            migrate();
 
         globalPheromoneUpdate();
 
@@ -254,7 +577,11 @@ void ACSHeuristic::optimize() {
             for (int j = 0; j < numHoles; j++)
                 routes[k][j] = -1;
         }
+        checkStop(it);
     }
+    // Polish the best tour with chained LK, within what is left of the time budget (none once it has run out)
+    if (kicks > 0)
+        bestLen += improver.chainedLK(bestRoute, kicks, rng, stop.deadline());
     //printPheromones();
     auto end = std::chrono::high_resolution_clock::now();
     solveTime = std::chrono::duration_cast<std::chrono::milliseconds>(end-start).count();
@@ -9,34 +9,30 @@
 #include "../../Utilities/typesAndDefs.h"
 #include "../../Instance Generators/boardGenerator.h"
 #include "../../Utilities/utils.h"
+#include "../../Utilities/threadPool.h"
+#include "../../Utilities/distanceProvider.h"
+#include "../Local Search/localSearch.h"
 #include <deque>
+#include <memory>
 #include <utility>
 #include "Ant.h"
+#include "stoppingRule.h"
+#include "islandMailbox.h"
 #include <climits>
+// Stored trails are renormalized once the global evaporation scale drops below this value to the power 1/alpha
+// (alpha > 1): stored trails grow as 1/scale, so their powers tau^alpha then stay below about 1e30
+#define PHEROMONE_RENORMALIZATION 1e-30
 // (unused) error values for invalid path found
 enum validity { noError = 0, invalidHoleIndex = -1, repeatedHoles = -3 };
 
 class ACSHeuristic {
 public:
-    /* Unused constructor for coordinate Matrix */ /*
-    ACSHeuristic(ACSparameters params, std::deque<std::pair<double,double>>& coordMap, double _sol, bool _sync) :
-            numAnts(params.numAnts), numHoles(coordMap.size()), iterations(params.iterations), alpha(params.alpha),
-            beta(params.beta), local_evaporation_rate(params.rho), global_evaporation_rate(params.omega), q_0 (params.greediness),
-            distMode(params.distMode),
-            concurrent(_sync)
-    {
-        boardGenerator::generateTimes(*distances, coordMap, distMode);
-        init();
-    }
-    */
-    ACSHeuristic(ACSparameters params, doubleMap *times, double _sol, bool _sync) :
-            numAnts(params.numAnts), numHoles(times->size()), iterations(params.iterations), alpha(params.alpha),
-            beta(params.beta), local_evaporation_rate(params.rho), global_evaporation_rate(params.omega), q_0 (params.greediness),
-            distMode(params.distMode), optimalSolution(_sol), concurrent(_sync)
-    {
-        distances = times;
-        init();
-    }
+    // Distances computed on demand from the coordinates (no n^2 distance matrix, trails still n^2: see distanceProvider)
+    ACSHeuristic(ACSparameters params, const std::deque<std::pair<double,double>>& coordMap, double _sol, bool _sync) :
+            ACSHeuristic(params, distanceProvider(coordMap, params.distMode), _sol, _sync) {}
+    // Distances read from a matrix (owned by the caller)
+    ACSHeuristic(ACSparameters params, const doubleMap *times, double _sol, bool _sync) :
+            ACSHeuristic(params, distanceProvider(times), _sol, _sync) {}
 
     void init();                            // Initialize structures
     void printPheromones();                 // Print pheromone trails
@@ -45,28 +41,83 @@ public:
     void optimize ();                       // Run Ant Colony System optimization
     long getTime() { return solveTime; }
     double getObj() { return bestLen; }
+    const std::vector<int>& getRoute() { return bestRoute; }
+    int getStopReason() { return stop.reason(); }   // Criterion that ended the last run (STOP_*)
+    int getIterations() { return stop.iterationsRun(); }
     void reset();
+    void reset(unsigned run);               // Start run number run (same random streams as after run resets)
+    void setThreads(unsigned numThreads);   // Replace the workers (0: one thread per hardware core)
+    void shareThreads(threadPool* shared);  // Run the ants on a pool owned by the caller (e.g. a batch of boards)
+    // Island model: exchange the best tour with the other colonies every _interval iterations
+    void joinIslands(islandMailbox* _mailbox, int _island, int _interval);
 private:
+    ACSHeuristic(ACSparameters params, distanceProvider _distances, double _sol, bool _sync) :
+            numAnts(params.numAnts), numHoles(_distances.size()), iterations(params.iterations), alpha(params.alpha),
+            beta(params.beta), local_evaporation_rate(params.rho), global_evaporation_rate(params.omega), q_0 (params.greediness),
+            distMode(params.distMode), candidateListSize(params.candidateListSize), seed(params.seed),
+            localUpdateMode(params.localUpdateMode), localSearchMode(params.localSearchMode),
+            localSearchScope(params.localSearchScope), kicks(params.kicks), vectorKernels(params.vectorKernels),
+            optimalSolution(_sol), stop(params, _sol),
+            concurrent(_sync), distances(std::move(_distances))
+    {
+        // Workers live as long as the heuristic (across iterations and reset())
+        ownPool = std::make_unique<threadPool>(concurrent ? 0 : 1);
+        pool = ownPool.get();
+        buildCandidateLists();
+        buildHeuristicInfo();
+        init();
+    }
     int valid(int ant_k);                   // Check whether a path is valid (not needed, feasible solutions are created)
     // void localPheromoneUpdateAS();       // Local pheromone update system for the (worse) Ant System algorithm
     void globalPheromoneUpdate();           // Global pheromone update, ran after every iteration on best path
-    bool isBest(int i, int j);
+    void globalUpdateOnBestEdges();         // Original ACS global update (asynchronous mode)
+    void renormalizePheromones();           // Fold the evaporation scale back into the stored trails
+    void updateBest(const workerBestList& workerBests);             // Iteration-best reduction
+    void reduceChunk(int first, int last, workerBest& best);        // Best ant of a chunk, per worker
+    void constructInLockStep(const std::vector<int>& startingHoles, workerBestList& workerBests);
+    void mergeLocalUpdates();               // Apply the deferred local updates of all ants
+    void constructAsynchronously();         // Asynchronous mode: workers build tours without iterations
+    void checkStop(int it);                 // Stopping criteria after an iteration (and other islands)
+    void migrate();                         // Publish the best tour, adopt the previous island's if shorter
+    void buildCandidateLists();             // Find the nearest holes of each hole (once per instance)
+    void buildHeuristicInfo();              // Compute eta^beta for every edge (once per instance)
     // Parameters and variables are better understood in their context in the .cpp file
     // --- Parameters ---
     int numAnts, numHoles, iterations;
     double alpha, beta, local_evaporation_rate, global_evaporation_rate, q_0;
-    int distMode;
+    int distMode, candidateListSize;
+    uint64_t seed;                          // Master seed (0: time-based)
+    int localUpdateMode;                    // LOCAL_UPDATE_RELAXED, _DEFERRED or _DETERMINISTIC
+    int localSearchMode, localSearchScope;  // LOCAL_SEARCH_* flags, and which tours they improve
+    int kicks;                              // Chained LK kicks on the final best tour
+    int vectorKernels;                      // KERNELS_* cap of the ants
     double optimalSolution = -1;
+    stoppingRule stop;                      // Iteration count, time budget, stall and target criteria
     bool concurrent;
     // --- Variables ---
     double bestLen = static_cast<double>(INT_MAX);
     std::vector<int> bestRoute;
-    intMap routes;
-    doubleMap pheromones, deltaPheromones, *distances;
+    intMap routes, candidates;
+    intMap neighbourLists;                  // Neighbours of the local search, if candidate lists are disabled
+    const intMap *neighbours = nullptr;     // Neighbours used by the local search (candidates or neighbourLists)
+    localSearch improver;                   // Local search of the iteration-best and final tours
+    doubleMap pheromones, deltaPheromones;
+    double pheromoneScale = 1.0;            // Lazy global evaporation: actual trail = pheromoneScale * pheromones
+    double renormalizeBelow = PHEROMONE_RENORMALIZATION;    // Scale that triggers a renormalization (see init)
+    distanceProvider distances;             // Shared (read-only) by all ants
+    doubleMap heuristicInfo, choiceInfo;    // eta^beta and tau^alpha * eta^beta for every edge
     std::vector<std::pair<double, int>> probs;
-    Utils ut;
+    uint64_t runSeed = 0;                   // Seed of the current run, derived from the master seed
+    unsigned runCount = 0;                  // Number of reset() so far (each run gets its own streams)
+    rngStream rng;                          // Colony stream (starting holes)
     long solveTime = -1;
     std::vector<Ant> antColony;
+    std::unique_ptr<threadPool> ownPool;    // Workers of this colony (unless shared)
+    threadPool* pool = nullptr;             // Workers running the ants
+    // --- Island model ---
+    islandMailbox* mailbox = nullptr;       // Shared with the other islands (nullptr: colony on its own)
+    int island = 0, migrationInterval = 0;
+    std::vector<int> immigrant;             // Tour received from another island
 };
 
 #endif //ACSHEURISTIC_H
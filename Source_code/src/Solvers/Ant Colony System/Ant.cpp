@@ -1,47 +1,51 @@
 #include "Ant.h"
 #include <string>
+#include <atomic>
+#include <algorithm>
 
 /**
  * @file Ant.h/cpp
  * @brief Ant agent for the ACS heuristic.
  */
 
-void Ant::init(unsigned _id, int _n, double* _best, std::vector<int>* _bestR, doubleMap* _pher,
-          doubleMap* _deltaPher, doubleMap& _dist, Utils* _u, double _a, double _b, double _ler, double _q)
+void Ant::init(unsigned _id, int _n, doubleMap* _pher, const double* _scale, doubleMap* _deltaPher, doubleMap* _choice, const doubleMap* _heur, const distanceProvider* _dist,
+          const intMap* _cand, uint64_t _seed, int _mode, int _lsMode, const intMap* _neigh, double _a, double _b, double _ler, double _q,
+          int _kernels)
     {
     /**
     * Initialize parameters for the current Ant
     * */
     id = _id;                               // ID of current Ant/process
     numHoles = _n;                          // Number of holes of the instance
-    bestLen = _best;                        // Best objective function (so far)
-    bestRoute = _bestR;                     // Best route found (so far)
-    pheromones = _pher;                     // Pheromone trail matrix
+    tourLength = -1;                        // Length of the last route found (-1: none yet)
+    pheromones = _pher;                     // Pheromone trail matrix (values divided by *pheromoneScale)
+    pheromoneScale = _scale;                // Global evaporation scale (actual trail = scale * stored value)
     deltaPheromones = _deltaPher;           // Pheromone variation matrix
-    distances = _dist;                      // Distances matrix
+    choiceInfo = _choice;                   // tau^alpha * eta^beta of every edge (kept in sync with pheromones)
+    heuristicInfo = _heur;                  // eta^beta of every edge
+    distances = _dist;                      // Distances, matrix or on demand (shared by all ants, never copied)
+    candidates = _cand;                     // Nearest holes of each hole (nullptr: consider all holes)
     alpha = _a;                             // Importance of pheromone value
+    alphaExponent = exponentId(alpha);      // Specialised power tau^alpha, if alpha is a small integer
     beta = _b;                              // Importance of heuristic value
     local_evaporation_rate = _ler;          // Local evaporation rate of pheromones
     q_0 = _q;                               // Pseudo random acceptance (ratio of acceptance of greedy steps)
-    ut = _u ;                               // Utility random generator
+    localUpdateMode = _mode;                // When local updates are applied (see typesAndDefs.h)
+    rng.seed(_seed, id + 1);                // Private random stream (stream 0 belongs to the colony)
+    localSearchMode = _lsMode;              // Local search applied to every route (LOCAL_SEARCH_* flags)
+    if (localSearchMode != LOCAL_SEARCH_NONE)
+        improver.init(numHoles, distances, _neigh);
     probs.resize(numHoles);
     for(int i=0; i<numHoles; i++)
         probs[i] = std::make_pair(-1.0, -1.0);
 
-    visitedNodes = new bool[numHoles];      // Truth vector of whether a hole has been  visited or not
-    for(int i=0; i<numHoles; i++)
-        visitedNodes[i] = false;
-}
-
-bool Ant::visited(int c) {
-    /*
-     * Determine whether ant_k has visited hole with index c
-     * -- Parameters --
-     * int c    : index of hole being checked
-     * -- Return --
-     * True if the hole with index c has been visited, false otherwise
-     * */
-    return visitedNodes[c];
+    // Visited holes, one bit each. Bits of the padding columns of choiceInfo are always set, so that the vector
+    // kernels can scan whole rows
+    visitedMask.assign((choiceInfo->stride() + 63) / 64, 0);
+    weights.resize(1, numHoles);
+    kernels = &antKernels::select(_kernels); // Vector kernels (fastest of this CPU, unless capped lower)
+    // Rows of weights written by other ants meanwhile: never scanned by the vector kernels (see Ant.h)
+    sharedRows = (localUpdateMode == LOCAL_UPDATE_RELAXED || localUpdateMode == LOCAL_UPDATE_ASYNCHRONOUS);
 }
 
 double Ant::pathWeight() {
@@ -53,46 +57,24 @@ double Ant::pathWeight() {
     double sum = 0.0;
     int i;
     for (i=0; i<numHoles-1; i++) {
-        sum += distances[(*route)[i]][(*route)[i + 1]];
+        sum += (*distances)((*route)[i], (*route)[i + 1]);
     }
-    sum += distances[(*route)[i]][(*route)[0]];
+    sum += (*distances)((*route)[i], (*route)[0]);
     return sum;
 }
 
-double Ant::explorationProbability(int hole_i, int hole_j) {
+int Ant::pickNextHole(int max, double sumWeights) {
     /**
-     * Probabilistic formula to determine the probability value of an ant to move between two given holes
-     * -- Parameters --
-     * int hole_i: index of outgoing hole
-     * int hole_j: index of incoming hole
-     * -- Return --
-     * The probability of an ant in hole_i to move to hole_j
-     * */
-    // Tau value for edge i-j. Corresponds to the pheromone trail edge
-    auto tau_i_j = static_cast<double>(pow((*pheromones)[hole_i][hole_j], alpha));
-    // Eta is a heuristic function
-    auto eta_i_j = static_cast<double>(pow(1/ distances[hole_i][hole_j], beta));
-    // Alpha: importance of pheromone trail. Beta: Importance of heuristic function
-    double sum_weights = 0.0;
-    for (int c=0; c < numHoles; c++){
-        // Set of non-visited holes
-        if (!visited(c)){
-            auto eta = static_cast<double>(pow (1/distances[hole_i][c], beta));
-            auto tau = static_cast<double>(pow ((*pheromones)[hole_i][c], alpha));
-            sum_weights += eta * tau;
-        }
-    }
-    return (eta_i_j * tau_i_j) / sum_weights;
-}
-
-int Ant::pickNextHole(int max) {
-    /**
-    * Determine next hole to walk to, randomly chosen based on probabilities
+    * Determine next hole to walk to, randomly chosen based on probabilities (roulette wheel selection).
+    * The probability of a hole is its weight over the sum of the weights of all the holes in probs.
+    * -- Parameters --
+    * int max               : number of holes in probs
+    * double sumWeights     : sum of the weights in probs
     * -- Return --
     * Index of chosen hole
     * */
-    // Generate a random uniform probability
-    double p = ut->generateRngZeroOne();
+    // Generate a random uniform point on the wheel
+    double p = rng.nextDouble() * sumWeights;
     int i = 0;
     double sum = probs[i].first;
     // Determine stochastically (based on p) which city to go to
@@ -113,31 +95,68 @@ int Ant::explore(int currentHole) {
     * Index of chosen hole
     * */
     int count = 0;
+    double sumWeights = 0.0;
     try{
-
-        // Iterate over other holes
-        // -- Generation phase: generate probabilities --
-        for (int j=0; j<numHoles; j++){
-            // if same hole, skip
-            if (currentHole == j)
-                continue;
-            // If the hole j has NOT been visited by ant_k, add to the pool of possibly chosen
-            if (!visited(j)) {
-                // Probability to move to j, based on pheromone values and parameters
-                probs[count].first = explorationProbability(currentHole, j);
-                // Remember that the associated probability refers to j
-                probs[count].second = j;
-                count++;
+        // -- Generation phase: generate weights --
+        // The weight of edge i-j is tau^alpha * eta^beta (alpha: importance of pheromone trail,
+        // beta: importance of heuristic function). Probabilities are weights over their sum.
+        // Only consider the nearest holes first, if candidate lists are in use
+        if (candidates != nullptr) {
+            for (int j : (*candidates)[currentHole]) {
+                if (!visited(j)) {
+                    probs[count].first = loadShared((*choiceInfo)[currentHole][j]);
+                    probs[count].second = j;
+                    sumWeights += probs[count].first;
+                    count++;
+                }
             }
         }
+        // Iterate over other holes (every candidate has already been visited, or no candidate list)
         if (count == 0)
-            throw std::runtime_error(std::string(__FILE__) + ": " + "Deadlocked ant! (no hole can be selected)");
+            return exploreAll(currentHole);
     } catch(std::exception& e) {
         std::cout << ">>>EXCEPTION: " << e.what() << std::endl;
         return -1;
     }
     // --- Selection phase: chose a hole to move to ---
-    return pickNextHole(count);
+    return pickNextHole(count, sumWeights);
+}
+
+int Ant::exploreAll(int currentHole) {
+    /**
+    * Roulette wheel selection among all the unvisited holes, with the vector kernels: the row of weights is
+    * masked with the visited bits, then the point drawn on the wheel is found with a running (prefix) sum.
+    * In relaxed and asynchronous modes, other ants may update the row meanwhile: it is masked one weight at a time,
+    * with atomic loads. The search only reads the masked copy, private to the ant.
+    * -- Parameters --
+    * int currentHole   : hole where the current Ant is residing
+    * -- Return --
+    * Index of chosen hole
+    * */
+    int n = static_cast<int>(choiceInfo->stride());
+    double sumWeights = 0.0;
+    if (sharedRows) {
+        for (int j=0; j<n; j++) {
+            weights[0][j] = visited(j) ? 0.0 : loadShared((*choiceInfo)[currentHole][j]);
+            sumWeights += weights[0][j];
+        }
+    } else {
+        sumWeights = kernels->maskWeights((*choiceInfo)[currentHole], visitedMask.data(), n, weights[0]);
+    }
+    if (sumWeights > 0.0) {
+        int j = kernels->search(weights[0], n, rng.nextDouble() * sumWeights);
+        if (j != -1)
+            return j;
+        // Rounding: the running sum stopped just short of the point drawn on the wheel
+        for (j = numHoles - 1; j >= 0; j--)
+            if (weights[0][j] > 0.0)
+                return j;
+    }
+    // Every weight is zero: first unvisited hole
+    for (int j=0; j<numHoles; j++)
+        if (!visited(j))
+            return j;
+    throw std::runtime_error(std::string(__FILE__) + ": " + "Deadlocked ant! (no hole can be selected)");
 }
 
 int Ant::exploit(int currentHole) {
@@ -151,58 +170,145 @@ int Ant::exploit(int currentHole) {
     * */
     int best_idx = -1;
     double best_tau_eta = 0.0;
-    // Iterate over other holes
-    for (int j=0; j<numHoles; j++){
-        // if same hole, skip
-        if (currentHole == j)
-            continue;
-        if (!visited(j)) {
-            // Deterministic value, whose maximum should be chosen in exploitation
-            auto current_tau_eta = static_cast<double>(pow((*pheromones)[currentHole][j], alpha))
-                                   *  static_cast<double>(pow(1/ distances[currentHole][j], beta));
-            if (current_tau_eta > best_tau_eta){
-                best_tau_eta = current_tau_eta;
-                best_idx = j;
+    // Only consider the nearest holes first, if candidate lists are in use
+    if (candidates != nullptr) {
+        for (int j : (*candidates)[currentHole]) {
+            if (!visited(j)) {
+                auto current_tau_eta = loadShared((*choiceInfo)[currentHole][j]);
+                if (current_tau_eta > best_tau_eta){
+                    best_tau_eta = current_tau_eta;
+                    best_idx = j;
+                }
             }
         }
+        if (best_idx != -1)
+            return best_idx;
     }
-    // --- Selection phase: chose a hole to move to ---
+    // Iterate over other holes (every candidate has already been visited, or no candidate list): the largest
+    // weight of the row among unvisited holes (vector kernels, unless other ants write the row: see exploreAll)
+    if (sharedRows) {
+        for (int j=0; j<numHoles; j++) {
+            if (!visited(j)) {
+                auto current_tau_eta = loadShared((*choiceInfo)[currentHole][j]);
+                if (current_tau_eta > best_tau_eta){
+                    best_tau_eta = current_tau_eta;
+                    best_idx = j;
+                }
+            }
+        }
+    } else {
+        best_idx = kernels->argmax((*choiceInfo)[currentHole], visitedMask.data(),
+                                   static_cast<int>(choiceInfo->stride()));
+    }
+    // No hole found: every weight is zero. Roulette wheel selection always finds a hole
+    if (best_idx == -1)
+        return exploreAll(currentHole);
     return best_idx;
 }
 
 
-void Ant::localPheromoneUpdate(int idxSoFar) {
+void Ant::localPheromoneUpdate(int idxSoFar, bool exact) {
     /*
      * Update the value of pheromones (each time an edge is selected)
      * -- Parameters --
      * int idxSoFar         : last element of the route vector that has been filled
+     * bool exact           : use compare-and-swap, so that no concurrent update of the same edge is lost, and
+     *                        leave the transition weights to the caller (see mergeLocalUpdates).
+     *                        Otherwise a relaxed load/store pair is used (cheaper; concurrent updates may be lost)
      * */
-        (*pheromones)[(*route)[idxSoFar]][(*route)[idxSoFar+1]] = (1 - local_evaporation_rate) * (*pheromones)[(*route)[idxSoFar]][(*route)[idxSoFar+1]]
-                                        + local_evaporation_rate * T_0;
-        (*pheromones)[(*route)[idxSoFar+1]][(*route)[idxSoFar]] = (1 - local_evaporation_rate) * (*pheromones)[(*route)[idxSoFar+1]][(*route)[idxSoFar]]
-                                        + local_evaporation_rate * T_0;
+    withExponent(alphaExponent, [&](auto a) { updateTrails<decltype(a)::value>(idxSoFar, exact); });
+}
+
+template <int A>
+void Ant::updateTrails(int idxSoFar, bool exact) {
+    /* See localPheromoneUpdate */
+    const std::vector<int>& tour = constructedRoute();
+    int i = tour[idxSoFar], j = tour[idxSoFar+1];
+    // Trails are stored divided by the global evaporation scale: T_0 is scaled the same way
+    double scaledT_0 = T_0 / (*pheromoneScale);
+    for (auto edge : {std::make_pair(i, j), std::make_pair(j, i)}) {
+        auto& trail = reinterpret_cast<std::atomic<double>&>((*pheromones)[edge.first][edge.second]);
+        double current = trail.load(std::memory_order_relaxed), updated;
+        if (exact) {
+            do {
+                updated = (1 - local_evaporation_rate) * current + local_evaporation_rate * scaledT_0;
+            } while (!trail.compare_exchange_weak(current, updated, std::memory_order_relaxed));
+            continue;
+        }
+        updated = (1 - local_evaporation_rate) * current + local_evaporation_rate * scaledT_0;
+        trail.store(updated, std::memory_order_relaxed);
+        // Only this edge changed: refresh its transition weight
+        storeShared((*choiceInfo)[edge.first][edge.second],
+                    power<A>::of(updated, alpha) * (*heuristicInfo)[edge.first][edge.second]);
+    }
+}
+
+void Ant::mergeLocalUpdates() {
+    /*
+     * Apply the local updates of every edge of the constructed route at once (deferred mode, after all ants are
+     * done, and before the iteration-best tour is improved).
+     * The local rule is the same affine map for every ant and no update is lost (compare-and-swap), so the
+     * result does not depend on the order in which ants are merged.
+     * Weights must be refreshed afterwards, once all ants are merged (refreshChoiceInfo).
+     * */
+    for (int i=0; i<numHoles-1; i++)
+        localPheromoneUpdate(i, true);
+}
+
+void Ant::refreshChoiceInfo() {
+    /*
+     * Recompute the transition weights of the edges of the route from the final trail values
+     * */
+    withExponent(alphaExponent, [this](auto a) { refreshWeights<decltype(a)::value>(); });
+}
+
+template <int A>
+void Ant::refreshWeights() {
+    /* See refreshChoiceInfo */
+    const std::vector<int>& tour = constructedRoute();
+    for (int r=0; r<numHoles-1; r++) {
+        int i = tour[r], j = tour[r+1];
+        storeShared((*choiceInfo)[i][j],
+                    power<A>::of(loadShared((*pheromones)[i][j]), alpha) * (*heuristicInfo)[i][j]);
+        storeShared((*choiceInfo)[j][i],
+                    power<A>::of(loadShared((*pheromones)[j][i]), alpha) * (*heuristicInfo)[j][i]);
+    }
 }
 
 void Ant::generateRoute() {
     /**
     * Generate a route for ant_k, based on exploration and exploitation strategies
     * */
-    // Start in a random position
-    (*route)[0] = startHole;
+    withExponent(alphaExponent, [this](auto a) { constructRoute<decltype(a)::value>(); });
+}
+
+template <int A>
+void Ant::constructRoute() {
+    /* See generateRoute */
     for (int i=0; i<numHoles-1; i++) {
-        // -- State transition rules: exploration/exploitation --
-        auto p = ut->generateRngZeroOne();
-        (*route)[i+1] = (p <= q_0) ? exploit((*route)[i]) : explore((*route)[i]);
-        // Update visited list
-        visitedNodes[(*route)[i+1]] = true;
-        localPheromoneUpdate(i);
+        step(i);
+        // Other modes apply local updates outside of the construction (see ACSHeuristic::optimize)
+        if (localUpdateMode == LOCAL_UPDATE_RELAXED)
+            updateTrails<A>(i, false);
     }
 }
 
+void Ant::step(int idxSoFar) {
+    /**
+    * Move to the next hole of the route
+    * -- Parameters --
+    * int idxSoFar         : last element of the route vector that has been filled
+    * */
+    // -- State transition rules: exploration/exploitation --
+    auto p = rng.nextDouble();
+    (*route)[idxSoFar+1] = (p <= q_0) ? exploit((*route)[idxSoFar]) : explore((*route)[idxSoFar]);
+    // Update visited list
+    markVisited((*route)[idxSoFar+1]);
+}
 
-void Ant::execute(int _start, std::vector<int>* _route){
+void Ant::start(int _start, std::vector<int>* _route){
     /**
-    * Execute actions for current Ant (generate a route)
+    * Reset the ant and place it on its starting hole
     * -- Parameters --
     * int _start                : starting hole for current Ant
     * std::vector<int>* _route  : Pointer to route object to be filled
@@ -210,21 +316,52 @@ void Ant::execute(int _start, std::vector<int>* _route){
     // Copy pointer to route in global routes vector
     route = _route;
     // Reset the ant
-    for (int j=0; j < numHoles; j++) {
+    for (int j=0; j < numHoles; j++)
         (*route)[j] = -1;
-        visitedNodes[j] = false;
-    }
+    std::fill(visitedMask.begin(), visitedMask.end(), 0);
+    // Padding columns count as visited
+    if (numHoles % 64 != 0)
+        visitedMask[numHoles / 64] = ~uint64_t(0) << (numHoles % 64);
+    for (std::size_t w = (numHoles + 63) / 64; w < visitedMask.size(); w++)
+        visitedMask[w] = ~uint64_t(0);
     // Randomly selected starting point
     startHole = _start;
-    visitedNodes[_start] = true;
+    markVisited(_start);
+    (*route)[0] = startHole;
+}
+
+void Ant::finish() {
+    /**
+    * Close the route, and improve it with local search (if enabled). Only the length is remembered: the best
+    * route of the iteration is picked by the colony after all ants are done.
+    * */
+    tourLength = pathWeight();
+    // Moves report their gain: no need to measure the route again
+    if (localSearchMode != LOCAL_SEARCH_NONE) {
+        // Deferred local updates must reinforce the edges the ant chose (as in the other modes): keep them
+        if (localUpdateMode == LOCAL_UPDATE_DEFERRED)
+            constructed = *route;
+        tourLength += improver.improve(*route, localSearchMode);
+    }
+}
+
+const std::vector<int>& Ant::constructedRoute() const {
+    /**
+    * -- Return --
+    * Route as built by the state transition rule: local search may have rewritten the route since (see finish)
+    * */
+    return (localUpdateMode == LOCAL_UPDATE_DEFERRED && localSearchMode != LOCAL_SEARCH_NONE) ? constructed : *route;
+}
+
+void Ant::execute(int _start, std::vector<int>* _route){
+    /**
+    * Execute actions for current Ant (generate a route)
+    * -- Parameters --
+    * int _start                : starting hole for current Ant
+    * std::vector<int>* _route  : Pointer to route object to be filled
+    * */
+    start(_start, _route);
     // Generate the cycle for the current ant
     generateRoute();
-    // Update the best length if it's better
-    double r_len = pathWeight();
-    if(r_len < (*bestLen)) {
-        (*bestLen) = r_len;
-        // Update best path
-        for (int i = 0; i < numHoles; i++)
-            (*bestRoute)[i] = (*route)[i];
-    }
+    finish();
 }
\ No newline at end of file
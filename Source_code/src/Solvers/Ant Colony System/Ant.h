@@ -8,36 +8,90 @@
 
 #include "../../Utilities/typesAndDefs.h"
 #include "../../Utilities/utils.h"
+#include "../../Utilities/rng.h"
+#include "../../Utilities/powers.h"
+#include "../Local Search/localSearch.h"
+#include "antKernels.h"
+#include <atomic>
 #define T_0 0.1
 
+// Trails and weights are shared by all ants: single values are accessed through relaxed atomics.
+// std::atomic<double> has the size and alignment of a double on every supported platform.
+// The vector kernels (antKernels) read whole rows with plain loads: they only scan the shared rows in the modes where
+// no ant writes them during construction (deferred, deterministic, none). In relaxed and asynchronous modes, rows of
+// weights are read one value at a time through loadShared (see sharedRows).
+static_assert(sizeof(std::atomic<double>) == sizeof(double), "std::atomic<double> must be laid out as a double");
+
+inline double loadShared(const double& value) {
+    return reinterpret_cast<const std::atomic<double>&>(value).load(std::memory_order_relaxed);
+}
+
+inline void storeShared(double& value, double newValue) {
+    reinterpret_cast<std::atomic<double>&>(value).store(newValue, std::memory_order_relaxed);
+}
+
+// Best ant seen by one worker during an iteration. Aligned on a cache line each (size rounded up to a whole line),
+// so workers never share a line. Kept in a workerBestList, whose allocator honours the alignment.
+struct alignas(MATRIX_ALIGNMENT) workerBest {
+    double length;
+    int ant;
+};
+typedef std::vector<workerBest, alignedAllocator<workerBest>> workerBestList;
+
 // Ant class. Parameters and functions are described in the .cpp file
 class Ant {
 public:
-    Ant() : id(0), numHoles(0), startHole(0), bestLen(nullptr), route(nullptr), bestRoute(nullptr),
-            pheromones(nullptr), deltaPheromones(nullptr), alpha(0.5), beta(0.5), local_evaporation_rate(0.1),  q_0(0.9), ut(nullptr){}
+    Ant() : id(0), numHoles(0), startHole(0), localUpdateMode(LOCAL_UPDATE_RELAXED),
+            localSearchMode(LOCAL_SEARCH_NONE), alphaExponent(GENERIC_EXPONENT), tourLength(-1), route(nullptr),
+            pheromones(nullptr), deltaPheromones(nullptr), choiceInfo(nullptr), pheromoneScale(nullptr), heuristicInfo(nullptr), distances(nullptr),
+            candidates(nullptr), kernels(&antKernels::select()), sharedRows(true), alpha(0.5), beta(0.5),
+            local_evaporation_rate(0.1),  q_0(0.9){}
 
-    void init(unsigned _id, int _n, double* _best, std::vector<int>* _bestR, doubleMap* _pher,
-              doubleMap* _deltaPher, doubleMap& _dist, Utils* _u, double _a, double _b, double _ler, double _q);
-    bool visited(int c);
+    void init(unsigned _id, int _n, doubleMap* _pher, const double* _scale, doubleMap* _deltaPher, doubleMap* _choice, const doubleMap* _heur, const distanceProvider* _dist,
+              const intMap* _cand, uint64_t _seed, int _mode, int _lsMode, const intMap* _neigh, double _a, double _b, double _ler, double _q,
+              int _kernels = KERNELS_AVX512);
+    bool visited(int c) const { return (visitedMask[c >> 6] >> (c & 63)) & 1; }
+    void markVisited(int c) { visitedMask[c >> 6] |= uint64_t(1) << (c & 63); }
     double pathWeight();
-    double explorationProbability(int hole_i, int hole_j);
-    int pickNextHole(int max);
+    int pickNextHole(int max, double sumWeights);
     int explore(int currentHole);
+    int exploreAll(int currentHole);
     int exploit(int currentHole);
     void generateRoute();
-    void localPheromoneUpdate(int idxSoFar);
+    void localPheromoneUpdate(int idxSoFar, bool exact = false);
+    void mergeLocalUpdates();
+    void refreshChoiceInfo();
+    void start(int _start, std::vector<int>* _route);
+    void step(int idxSoFar);
+    void finish();
     void execute(int _start, std::vector<int>* _route);
+    double getTourLength() const { return tourLength; }
 private:
+    // Specialised on the id of alpha (see powers.h): alpha = 1 needs no pow() at all
+    template <int A> void constructRoute();
+    template <int A> void updateTrails(int idxSoFar, bool exact);
+    template <int A> void refreshWeights();
+    const std::vector<int>& constructedRoute() const;
+
     unsigned id;
-    int numHoles, startHole;
-    double* bestLen;
-    std::vector<int> *route, *bestRoute;
-    bool *visitedNodes;
+    int numHoles, startHole, localUpdateMode, localSearchMode;
+    int alphaExponent;
+    double tourLength;
+    std::vector<int> *route;
+    std::vector<int> constructed;           // Route before local search (deferred mode, see constructedRoute)
+    std::vector<uint64_t> visitedMask;      // One bit per hole (and per padding column of the matrices)
+    doubleMap weights;                      // Masked transition weights of the current hole (explore)
     std::vector<std::pair<double, int>> probs;
-    doubleMap *pheromones, *deltaPheromones;
-    doubleMap distances;
+    doubleMap *pheromones, *deltaPheromones, *choiceInfo;
+    const double *pheromoneScale;
+    const doubleMap *heuristicInfo;
+    const distanceProvider *distances;
+    const intMap *candidates;
+    const antKernels *kernels;
+    bool sharedRows;                        // Other ants write the rows of weights during construction
     double alpha, beta, local_evaporation_rate, q_0;
-    Utils *ut;
+    rngStream rng;
+    localSearch improver;
 };
 
 
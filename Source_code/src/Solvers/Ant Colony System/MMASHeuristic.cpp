@@ -0,0 +1,307 @@
+#include "MMASHeuristic.h"
+#include <chrono>
+#include <iomanip>
+#include <algorithm>
+
+/**
+ * @file MMASHeuristic.h/cpp
+ * @brief MAX-MIN Ant System: same ants as ACS, bounded trails and restarts on stagnation.
+ */
+
+void MMASHeuristic::init() {
+    /**
+    * Initialize the necessary variables
+    * */
+    uint64_t master = (seed != 0) ? seed
+                      : static_cast<uint64_t>(std::chrono::high_resolution_clock::now().time_since_epoch().count());
+    runSeed = rngStream(master, runCount).next();
+    rng.seed(runSeed, 0);
+    pheromones.resize(numHoles, numHoles);
+    choiceInfo.resize(numHoles, numHoles);
+    bestLen = restartBestLen = static_cast<double>(INT_MAX);
+    bestRoute.resize(numHoles);
+    restartBestRoute.resize(numHoles);
+    restartBestIteration = 0;
+    restarts = 0;
+    // Trails start at tau_max, estimated from the length of a nearest neighbour tour
+    std::vector<int> tour;
+    setBounds(localSearch::nearestNeighbourTour(distances, *neighbours, rng.nextInt(numHoles), tour));
+    resetTrails();
+    // Ants: no local updates, and always the random proportional rule (q_0 = 0)
+    routes.resize(numAnts);
+    antColony.resize(numAnts);
+    for (int i=0; i<numAnts; i++) {
+        routes[i].resize(numHoles);
+        antColony[i].init(i, numHoles, &pheromones, &pheromoneScale, nullptr, &choiceInfo, &heuristicInfo, &distances,
+                          (candidates.empty() ? nullptr : &candidates), runSeed, LOCAL_UPDATE_NONE,
+                          (localSearchScope == LOCAL_SEARCH_EVERY_ANT) ? localSearchMode : LOCAL_SEARCH_NONE,
+                          neighbours, alpha, beta, 0.0, 0.0, vectorKernels);
+    }
+}
+
+void MMASHeuristic::buildCandidateLists() {
+    /**
+    * Build the candidate lists of the ants (if candidateListSize > 0) and the neighbour lists of the nearest
+    * neighbour tour and of the local search (candidate lists, or the LOCAL_SEARCH_NEIGHBOURS nearest holes)
+    * */
+    candidates.clear();
+    neighbourLists.clear();
+    if (candidateListSize > 0) {
+        localSearch::nearestHoles(distances, candidateListSize, candidates, pool.get());
+        neighbours = &candidates;
+    } else {
+        localSearch::nearestHoles(distances, LOCAL_SEARCH_NEIGHBOURS, neighbourLists, pool.get());
+        neighbours = &neighbourLists;
+    }
+    if (localSearchMode == LOCAL_SEARCH_NONE && kicks <= 0)
+        return;
+    // Local search moves reverse parts of the tour: they are only valid with symmetric distances
+    if (!distances.symmetric()) {
+        std::cout << "Local search disabled: distances are not symmetric." << std::endl;
+        localSearchMode = LOCAL_SEARCH_NONE;
+        kicks = 0;
+        return;
+    }
+    improver.init(numHoles, &distances, neighbours);
+}
+
+void MMASHeuristic::buildHeuristicInfo() {
+    /**
+    * Compute eta^beta (with eta = 1/distance) for every edge, once per instance
+    * */
+    heuristicInfo.resize(numHoles, numHoles);
+    withExponent(exponentId(beta), [this](auto b) {
+        for (int i=0; i<numHoles; i++)
+            for (int j=0; j<numHoles; j++)
+                heuristicInfo[i][j] = (i == j) ? 0.0 : power<decltype(b)::value>::of(1 / distances(i, j), beta);
+    });
+}
+
+void MMASHeuristic::reset() {
+    /* Reset current values */
+    pheromones.clear();
+    choiceInfo.clear();
+    bestRoute.clear();
+    restartBestRoute.clear();
+    routes.clear();
+    antColony.clear();
+    runCount++;
+    init();
+}
+
+void MMASHeuristic::setBounds(double length) {
+    /**
+    * Trail bounds: tau_max is the limit of a trail reinforced at every iteration by a tour of the given length,
+    * tau_min is such that, once trails have converged, the best tour is built with probability MMAS_P_BEST
+    * -- Parameters --
+    * double length     : length of the best tour so far
+    * */
+    tauMax = 1 / (evaporation_rate * length);
+    double pDec = pow(MMAS_P_BEST, 1.0 / numHoles);
+    double avgChoices = numHoles / 2.0;
+    tauMin = std::min(tauMax, tauMax * (1 - pDec) / ((avgChoices - 1) * pDec));
+}
+
+void MMASHeuristic::resetTrails() {
+    /* (Re)start from uniform trails at tau_max: maximal exploration */
+    pheromones.fill(tauMax);
+    refreshChoiceInfo();
+}
+
+void MMASHeuristic::refreshChoiceInfo() {
+    /**
+    * Recompute tau^alpha * eta^beta for every edge (rows are split between the workers)
+    * */
+    withExponent(exponentId(alpha), [this](auto a) {
+        pool->parallelFor(numHoles, pool->chunkFor(numHoles), [this](int first, int last, unsigned) {
+            for (int i=first; i<last; i++)
+                for (int j=0; j<numHoles; j++)
+                    choiceInfo[i][j] = power<decltype(a)::value>::of(pheromones[i][j], alpha) * heuristicInfo[i][j];
+        });
+    });
+}
+
+void MMASHeuristic::globalPheromoneUpdate(const std::vector<int>& route, double length) {
+    /**
+    * Evaporate every trail (never below tau_min), then reinforce the edges of a tour (never above tau_max)
+    * -- Parameters --
+    * const std::vector<int>& route     : tour being reinforced
+    * double length                     : its length
+    * */
+    double persistence = 1 - evaporation_rate;
+    pool->parallelFor(numHoles, pool->chunkFor(numHoles), [this, persistence](int first, int last, unsigned) {
+        for (int i=first; i<last; i++)
+            for (int j=0; j<numHoles; j++)
+                pheromones[i][j] = std::max(tauMin, persistence * pheromones[i][j]);
+    });
+    double deposit = 1 / length;
+    for (int r=0; r<numHoles; r++) {
+        int i = route[r], j = route[(r + 1) % numHoles];
+        pheromones[i][j] = std::min(tauMax, pheromones[i][j] + deposit);
+        pheromones[j][i] = pheromones[i][j];
+    }
+    refreshChoiceInfo();
+}
+
+double MMASHeuristic::branchingFactor() {
+    /**
+    * Average lambda-branching factor: for each hole, the number of edges whose trail is still significant
+    * (above tau_min + MMAS_LAMBDA of the range of the trails of the hole)
+    * -- Return --
+    * Average number of significant edges per hole, over the 2 edges of a tour (1: trails have converged)
+    * */
+    double total = 0.0;
+    for (int i=0; i<numHoles; i++) {
+        double low = tauMax, high = 0.0;
+        for (int j=0; j<numHoles; j++) {
+            if (i == j)
+                continue;
+            low = std::min(low, pheromones[i][j]);
+            high = std::max(high, pheromones[i][j]);
+        }
+        double cutoff = low + MMAS_LAMBDA * (high - low);
+        for (int j=0; j<numHoles; j++)
+            if (i != j && pheromones[i][j] >= cutoff)
+                total += 1.0;
+    }
+    return total / (2.0 * numHoles);
+}
+
+void MMASHeuristic::reduceChunk(int first, int last, workerBest& best) {
+    /**
+    * Fold the tours of ants [first, last) into the best ant seen by a worker
+    * */
+    for (int ant_k=first; ant_k < last; ant_k++) {
+        double len = antColony[ant_k].getTourLength();
+        if (best.ant == -1 || len < best.length || (len == best.length && ant_k < best.ant)) {
+            best.length = len;
+            best.ant = ant_k;
+        }
+    }
+}
+
+int MMASHeuristic::updateBest(const workerBestList& workerBests, double& iterationLen) {
+    /**
+    * Find the iteration-best ant (improved by local search, if it is only applied to it), then update the best tour
+    * of the restart and the best tour so far (and the trail bounds, which depend on it)
+    * -- Parameters --
+    * const workerBestList& workerBests         : best ant found by each worker in this iteration
+    * double& iterationLen                      : set to the length of the iteration-best tour
+    * -- Return --
+    * Index of the iteration-best ant
+    * */
+    int iterationBest = -1;
+    for (const auto& best : workerBests) {
+        if (best.ant == -1)
+            continue;
+        if (iterationBest == -1 || best.length < iterationLen
+            || (best.length == iterationLen && best.ant < iterationBest)) {
+            iterationLen = best.length;
+            iterationBest = best.ant;
+        }
+    }
+    if (localSearchMode != LOCAL_SEARCH_NONE && localSearchScope == LOCAL_SEARCH_ITERATION_BEST)
+        iterationLen += improver.improve(routes[iterationBest], localSearchMode);
+    if (iterationLen < restartBestLen) {
+        restartBestLen = iterationLen;
+        restartBestRoute = routes[iterationBest];
+    }
+    if (iterationLen < bestLen) {
+        bestLen = iterationLen;
+        bestRoute = routes[iterationBest];
+        setBounds(bestLen);
+    }
+    return iterationBest;
+}
+
+void MMASHeuristic::printSpecifics() {
+    /**
+    * Print the specifics being run
+    * */
+    std::cout << "-- Parameters (MAX-MIN Ant System) --" << std::endl;
+    std::cout << "    Number of ants           :      " << numAnts << std::endl;
+    std::cout << "    Number of holes          :      " << numHoles << std::endl;
+    std::cout << "    Stopping criteria        :      ";
+    stop.print();
+    std::cout << std::endl;
+    std::cout << "    Concurrency enabled      :      " << ((concurrent) ? "Yes" : "No")
+              << " (" << pool->size() << " thread(s))" << std::endl;
+    std::cout << "    Candidate list size      :      "
+              << ((candidates.empty()) ? "All holes" : std::to_string(candidates[0].size())) << std::endl;
+    std::cout << "    Vector kernels           :      " << antKernels::select(vectorKernels).name << std::endl;
+    std::cout << "    Misc parameters..." << "\n    | Alpha: " << alpha << " | Beta: " << beta
+              << " | Evaporation rate : " << evaporation_rate << " | p_best : " << MMAS_P_BEST << " |" << std::endl;
+}
+
+void MMASHeuristic::printResults() {
+    /**
+    * Print results of optimization
+    * */
+    std::cout << "-- Optimization results (MAX-MIN Ant System) --" << std::endl;
+    std::cout << "    Best path: ";
+    for (auto hole : bestRoute)
+        std::cout << hole << " ";
+    std::cout << "\n    Number of ants        :      " << numAnts << std::endl;
+    std::cout << "    Number of iterations  :      " << stop.iterationsRun() << std::endl;
+    std::cout << "    Stopped by            :      " << stoppingRule::describe(stop.reason()) << std::endl;
+    std::cout << "    Trail restarts        :      " << restarts << std::endl;
+    std::cout << "    Found obj             :      " << bestLen << std::endl;
+    if (optimalSolution != -1) {
+        std::cout << "    Optimal obj           :      " << optimalSolution << std::endl;
+        std::cout << "    This is " << std::setprecision(4) << Utils::percentDifference(bestLen, optimalSolution)
+                  << "% off the optimal solution." << std::endl;
+    }
+    std::cout << "    Optimization took "
+              << solveTime << " milliseconds (" << solveTime/1000.0 << " second(s))."  << std::endl;
+}
+
+void MMASHeuristic::optimize() {
+    /**
+    * Optimize problem until one of the stopping criteria is met (see stoppingRule)
+    * */
+    std::vector<int> startingHoles(numAnts);
+    int antsPerChunk = pool->chunkFor(numAnts);
+    workerBestList workerBests(pool->size());
+    double branchingLimit = 1.0 + std::max(MMAS_BRANCHING_SLACK * numHoles, 1.0) / (2.0 * numHoles);
+
+    auto start = std::chrono::high_resolution_clock::now();
+    stop.start();
+    // -- Optimization --
+    for (int it=0; !stop.stopped(); it++) {
+        for (int ant_k=0; ant_k < numAnts; ant_k++)
+            startingHoles[ant_k] = rng.nextInt(numHoles);
+        for (auto& best : workerBests)
+            best.ant = -1;
+        pool->parallelFor(numAnts, antsPerChunk,
+                          [this, &startingHoles, &workerBests](int first, int last, unsigned worker) {
+            for (int ant_k=first; ant_k < last; ant_k++)
+                antColony[ant_k].execute(startingHoles[ant_k], &routes[ant_k]);
+            reduceChunk(first, last, workerBests[worker]);
+        });
+        double restartBefore = restartBestLen, iterationLen = 0.0;
+        int iterationBest = updateBest(workerBests, iterationLen);
+        if (restartBestLen < restartBefore)
+            restartBestIteration = it;
+
+        // Mostly reinforce the iteration best (exploration), sometimes the best tour since the last restart
+        if (it % MMAS_BEST_SO_FAR_FREQUENCY == 0)
+            globalPheromoneUpdate(restartBestRoute, restartBestLen);
+        else
+            globalPheromoneUpdate(routes[iterationBest], iterationLen);
+
+        // -- Stagnation: all ants build (nearly) the same tour, and it has not improved for a while --
+        if (it % MMAS_BRANCHING_CHECK == 0 && it - restartBestIteration > MMAS_RESTART_ITERATIONS
+            && branchingFactor() <= branchingLimit) {
+            restartBestLen = static_cast<double>(INT_MAX);
+            restartBestIteration = it;
+            resetTrails();
+            restarts++;
+        }
+        stop.update(it, bestLen);
+    }
+    // Polish the best tour with chained LK, within what is left of the time budget (none once it has run out)
+    if (kicks > 0)
+        bestLen += improver.chainedLK(bestRoute, kicks, rng, stop.deadline());
+    auto end = std::chrono::high_resolution_clock::now();
+    solveTime = std::chrono::duration_cast<std::chrono::milliseconds>(end-start).count();
+}
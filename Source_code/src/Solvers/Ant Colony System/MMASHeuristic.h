@@ -0,0 +1,112 @@
+#ifndef MMASHEURISTIC_H
+#define MMASHEURISTIC_H
+
+/**
+ * @file MMASHeuristic.h/cpp
+ * @brief MAX-MIN Ant System: same ants as ACS, bounded trails and restarts on stagnation.
+ */
+
+#include "../../Utilities/typesAndDefs.h"
+#include "../../Utilities/utils.h"
+#include "../../Utilities/threadPool.h"
+#include "../../Utilities/distanceProvider.h"
+#include "../Local Search/localSearch.h"
+#include "Ant.h"
+#include "stoppingRule.h"
+#include <climits>
+#include <deque>
+#include <memory>
+#include <stdexcept>
+
+// Probability that an ant builds the best tour once trails have converged (sets tau_min with respect to tau_max)
+#define MMAS_P_BEST 0.05
+// An edge counts in the lambda-branching factor of a hole if its trail is above tau_min + lambda * (range of the hole)
+#define MMAS_LAMBDA 0.05
+// Trails have converged once the average branching factor (per tour edge, 1 when only tour edges are left) is at
+// most 1 + extra / (2 * numHoles), extra being MMAS_BRANCHING_SLACK of the holes (at least one): up to that many
+// holes may keep one significant edge besides their two tour edges (limit 1.01 on large boards, ~1.04 at 12 holes)...
+#define MMAS_BRANCHING_SLACK 0.02
+// ...it is checked every MMAS_BRANCHING_CHECK iterations, and trails are only reset after
+// MMAS_RESTART_ITERATIONS iterations without improving the best tour of the current restart
+#define MMAS_BRANCHING_CHECK 100
+#define MMAS_RESTART_ITERATIONS 250
+// Every MMAS_BEST_SO_FAR_FREQUENCY iterations, the best tour of the restart is reinforced instead of the iteration best
+#define MMAS_BEST_SO_FAR_FREQUENCY 25
+
+class MMASHeuristic {
+public:
+    // Distances computed on demand from the coordinates (no n^2 distance matrix, trails still n^2: see distanceProvider)
+    MMASHeuristic(ACSparameters params, const std::deque<std::pair<double,double>>& coordMap, double _sol, bool _sync) :
+            MMASHeuristic(params, distanceProvider(coordMap, params.distMode), _sol, _sync) {}
+    // Distances read from a matrix (owned by the caller)
+    MMASHeuristic(ACSparameters params, const doubleMap *times, double _sol, bool _sync) :
+            MMASHeuristic(params, distanceProvider(times), _sol, _sync) {}
+
+    void init();                            // Initialize structures
+    void printResults();                    // Print results of optimization
+    void printSpecifics();                  // Print specifics being used
+    void optimize();                        // Run MAX-MIN Ant System optimization
+    long getTime() { return solveTime; }
+    double getObj() { return bestLen; }
+    const std::vector<int>& getRoute() { return bestRoute; }
+    int getStopReason() { return stop.reason(); }   // Criterion that ended the last run (STOP_*)
+    int getIterations() { return stop.iterationsRun(); }
+    int getRestarts() { return restarts; }
+    void reset();
+private:
+    MMASHeuristic(ACSparameters params, distanceProvider _distances, double _sol, bool _sync) :
+            numAnts(params.numAnts), numHoles(_distances.size()), iterations(params.iterations), alpha(params.alpha),
+            beta(params.beta), evaporation_rate(params.omega), candidateListSize(params.candidateListSize),
+            seed(params.seed), localSearchMode(params.localSearchMode), localSearchScope(params.localSearchScope),
+            kicks(params.kicks), vectorKernels(params.vectorKernels), optimalSolution(_sol), stop(params, _sol),
+            concurrent(_sync), distances(std::move(_distances))
+    {
+        // Every iteration reinforces the iteration-best tour: at least one ant must build one
+        if (numAnts < 1)
+            throw std::runtime_error(std::string(__FILE__) + ": " + "MAX-MIN Ant System needs at least one ant.");
+        pool = std::make_unique<threadPool>(concurrent ? 0 : 1);
+        buildCandidateLists();
+        buildHeuristicInfo();
+        init();
+    }
+    void buildCandidateLists();             // Candidate and neighbour lists (once per instance)
+    void buildHeuristicInfo();              // eta^beta for every edge (once per instance)
+    void setBounds(double length);          // tau_max and tau_min from the length of the best tour so far
+    void resetTrails();                     // Every trail to tau_max
+    void globalPheromoneUpdate(const std::vector<int>& route, double length);
+    void refreshChoiceInfo();
+    double branchingFactor();               // Average lambda-branching factor of the trails
+    int updateBest(const workerBestList& workerBests, double& iterationLen);
+    void reduceChunk(int first, int last, workerBest& best);
+    // --- Parameters ---
+    int numAnts, numHoles, iterations;
+    double alpha, beta, evaporation_rate;
+    int candidateListSize;
+    uint64_t seed;
+    int localSearchMode, localSearchScope, kicks;
+    int vectorKernels;                      // KERNELS_* cap of the ants
+    double optimalSolution = -1;
+    stoppingRule stop;                      // Iteration count, time budget, stall and target criteria
+    bool concurrent;
+    // --- Variables ---
+    double bestLen = static_cast<double>(INT_MAX);
+    std::vector<int> bestRoute;
+    double restartBestLen = static_cast<double>(INT_MAX);
+    std::vector<int> restartBestRoute;      // Best tour since the last restart
+    int restartBestIteration = 0, restarts = 0;
+    double tauMax = 1.0, tauMin = 0.0;
+    intMap routes, candidates, neighbourLists;
+    const intMap *neighbours = nullptr;
+    doubleMap pheromones, heuristicInfo, choiceInfo;
+    double pheromoneScale = 1.0;            // Always 1 (ants read it only for local updates, which MMAS does not do)
+    distanceProvider distances;
+    localSearch improver;
+    uint64_t runSeed = 0;
+    unsigned runCount = 0;
+    rngStream rng;
+    long solveTime = -1;
+    std::vector<Ant> antColony;
+    std::unique_ptr<threadPool> pool;
+};
+
+#endif //MMASHEURISTIC_H
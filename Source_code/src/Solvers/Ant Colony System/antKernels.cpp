@@ -0,0 +1,236 @@
+#include "antKernels.h"
+#include <algorithm>
+
+/**
+ * @file antKernels.h/cpp
+ * @brief Vectorised (AVX2/AVX-512) loops of the state transition rule, with a scalar fallback chosen at runtime.
+ */
+
+// Vector kernels are compiled with per-function target attributes (no global -mavx flags needed), and only
+// called once the CPU has been checked: the same binary runs on any x86-64 machine.
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define ANT_KERNELS_X86 1
+#include <immintrin.h>
+#else
+#define ANT_KERNELS_X86 0
+#endif
+
+static inline bool isVisited(const uint64_t* visited, int j) {
+    return (visited[j >> 6] >> (j & 63)) & 1;
+}
+
+// --- Scalar ---
+
+static int argmaxScalar(const double* weights, const uint64_t* visited, int n) {
+    int best = -1;
+    double bestWeight = 0.0;
+    for (int j=0; j<n; j++) {
+        if (!isVisited(visited, j) && weights[j] > bestWeight) {
+            bestWeight = weights[j];
+            best = j;
+        }
+    }
+    return best;
+}
+
+static double maskWeightsScalar(const double* weights, const uint64_t* visited, int n, double* out) {
+    double sum = 0.0;
+    for (int j=0; j<n; j++) {
+        out[j] = isVisited(visited, j) ? 0.0 : weights[j];
+        sum += out[j];
+    }
+    return sum;
+}
+
+static int searchScalar(const double* weights, int n, double target) {
+    double sum = 0.0;
+    for (int j=0; j<n; j++) {
+        sum += weights[j];
+        if (sum > target)
+            return j;
+    }
+    return -1;
+}
+
+#if ANT_KERNELS_X86
+
+// --- AVX2 (4 doubles per vector) ---
+
+__attribute__((target("avx2")))
+static inline __m256d unvisitedAVX2(const uint64_t* visited, int j) {
+    /* All-ones lanes for the unvisited holes j..j+3 (j is a multiple of 4: the 4 bits are in the same word) */
+    long long bits = static_cast<long long>((visited[j >> 6] >> (j & 63)) & 0xF);
+    __m256i lanes = _mm256_and_si256(_mm256_set1_epi64x(bits), _mm256_setr_epi64x(1, 2, 4, 8));
+    return _mm256_castsi256_pd(_mm256_cmpeq_epi64(lanes, _mm256_setzero_si256()));
+}
+
+__attribute__((target("avx2")))
+static inline double lastLaneAVX2(__m256d v) {
+    __m128d high = _mm256_extractf128_pd(v, 1);
+    return _mm_cvtsd_f64(_mm_unpackhi_pd(high, high));
+}
+
+__attribute__((target("avx2")))
+static int argmaxAVX2(const double* weights, const uint64_t* visited, int n) {
+    // First pass: largest weight (visited holes count as 0, which is never selected)
+    __m256d best = _mm256_setzero_pd();
+    for (int j=0; j<n; j+=4)
+        best = _mm256_max_pd(best, _mm256_and_pd(_mm256_load_pd(weights + j), unvisitedAVX2(visited, j)));
+    __m128d half = _mm_max_pd(_mm256_castpd256_pd128(best), _mm256_extractf128_pd(best, 1));
+    double bestWeight = _mm_cvtsd_f64(_mm_max_sd(half, _mm_unpackhi_pd(half, half)));
+    if (!(bestWeight > 0.0))
+        return -1;
+    // Second pass: first unvisited hole with that weight (same choice as the scalar loop)
+    __m256d target = _mm256_set1_pd(bestWeight);
+    for (int j=0; j<n; j+=4) {
+        __m256d equal = _mm256_cmp_pd(_mm256_load_pd(weights + j), target, _CMP_EQ_OQ);
+        int bits = _mm256_movemask_pd(_mm256_and_pd(equal, unvisitedAVX2(visited, j)));
+        if (bits != 0)
+            return j + __builtin_ctz(bits);
+    }
+    return -1;
+}
+
+__attribute__((target("avx2")))
+static double maskWeightsAVX2(const double* weights, const uint64_t* visited, int n, double* out) {
+    __m256d sum = _mm256_setzero_pd();
+    for (int j=0; j<n; j+=4) {
+        __m256d w = _mm256_and_pd(_mm256_load_pd(weights + j), unvisitedAVX2(visited, j));
+        _mm256_store_pd(out + j, w);
+        sum = _mm256_add_pd(sum, w);
+    }
+    __m128d half = _mm_add_pd(_mm256_castpd256_pd128(sum), _mm256_extractf128_pd(sum, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half)));
+}
+
+__attribute__((target("avx2")))
+static int searchAVX2(const double* weights, int n, double target) {
+    const __m256d zero = _mm256_setzero_pd(), goal = _mm256_set1_pd(target);
+    double running = 0.0;
+    for (int j=0; j<n; j+=4) {
+        // In-register inclusive prefix sum: add the vector shifted by one lane, then by two lanes
+        __m256d v = _mm256_load_pd(weights + j);
+        v = _mm256_add_pd(v, _mm256_blend_pd(_mm256_permute4x64_pd(v, _MM_SHUFFLE(2, 1, 0, 0)), zero, 0x1));
+        v = _mm256_add_pd(v, _mm256_blend_pd(_mm256_permute4x64_pd(v, _MM_SHUFFLE(1, 0, 0, 0)), zero, 0x3));
+        v = _mm256_add_pd(v, _mm256_set1_pd(running));
+        int bits = _mm256_movemask_pd(_mm256_cmp_pd(v, goal, _CMP_GT_OQ));
+        if (bits != 0)
+            return j + __builtin_ctz(bits);
+        running = lastLaneAVX2(v);
+    }
+    return -1;
+}
+
+// --- AVX-512 (8 doubles per vector) ---
+
+__attribute__((target("avx512f")))
+static inline __mmask8 unvisitedAVX512(const uint64_t* visited, int j) {
+    return static_cast<__mmask8>(~(visited[j >> 6] >> (j & 63)) & 0xFF);
+}
+
+// Lane extractions of immintrin.h (casts, _mm512_reduce_*_pd) trigger false uninitialized warnings with some GCC
+// versions: lanes are read back from memory instead, and unmasked operations go through their zero-masked forms
+__attribute__((target("avx512f")))
+static inline void lanesAVX512(__m512d v, double* lanes) {
+    _mm512_store_pd(lanes, v);
+}
+
+__attribute__((target("avx512f")))
+static int argmaxAVX512(const double* weights, const uint64_t* visited, int n) {
+    __m512d best = _mm512_setzero_pd();
+    for (int j=0; j<n; j+=8)
+        best = _mm512_maskz_max_pd(0xFF, best, _mm512_maskz_load_pd(unvisitedAVX512(visited, j), weights + j));
+    alignas(64) double lanes[8];
+    lanesAVX512(best, lanes);
+    double bestWeight = *std::max_element(lanes, lanes + 8);
+    if (!(bestWeight > 0.0))
+        return -1;
+    __m512d target = _mm512_set1_pd(bestWeight);
+    for (int j=0; j<n; j+=8) {
+        __mmask8 equal = _mm512_mask_cmp_pd_mask(unvisitedAVX512(visited, j), _mm512_load_pd(weights + j),
+                                                 target, _CMP_EQ_OQ);
+        if (equal != 0)
+            return j + __builtin_ctz(equal);
+    }
+    return -1;
+}
+
+__attribute__((target("avx512f")))
+static double maskWeightsAVX512(const double* weights, const uint64_t* visited, int n, double* out) {
+    __m512d sum = _mm512_setzero_pd();
+    for (int j=0; j<n; j+=8) {
+        __m512d w = _mm512_maskz_load_pd(unvisitedAVX512(visited, j), weights + j);
+        _mm512_store_pd(out + j, w);
+        sum = _mm512_add_pd(sum, w);
+    }
+    // Pairwise, like the vector reduction
+    alignas(64) double lanes[8];
+    lanesAVX512(sum, lanes);
+    return ((lanes[0] + lanes[4]) + (lanes[2] + lanes[6])) + ((lanes[1] + lanes[5]) + (lanes[3] + lanes[7]));
+}
+
+__attribute__((target("avx512f")))
+static int searchAVX512(const double* weights, int n, double target) {
+    // Lane i takes lane i-1, i-2, i-4 (lanes below the shift are zeroed by the mask)
+    const __m512i shift1 = _mm512_setr_epi64(0, 0, 1, 2, 3, 4, 5, 6);
+    const __m512i shift2 = _mm512_setr_epi64(0, 0, 0, 1, 2, 3, 4, 5);
+    const __m512i shift4 = _mm512_setr_epi64(0, 0, 0, 0, 0, 1, 2, 3);
+    const __m512d goal = _mm512_set1_pd(target);
+    alignas(64) double lanes[8];
+    double running = 0.0;
+    for (int j=0; j<n; j+=8) {
+        __m512d v = _mm512_load_pd(weights + j);
+        v = _mm512_add_pd(v, _mm512_maskz_permutexvar_pd(0xFE, shift1, v));
+        v = _mm512_add_pd(v, _mm512_maskz_permutexvar_pd(0xFC, shift2, v));
+        v = _mm512_add_pd(v, _mm512_maskz_permutexvar_pd(0xF0, shift4, v));
+        v = _mm512_add_pd(v, _mm512_set1_pd(running));
+        __mmask8 above = _mm512_cmp_pd_mask(v, goal, _CMP_GT_OQ);
+        if (above != 0)
+            return j + __builtin_ctz(above);
+        lanesAVX512(v, lanes);
+        running = lanes[7];
+    }
+    return -1;
+}
+
+#endif
+
+static const antKernels kernelSets[] = {
+    {"scalar", KERNELS_SCALAR, argmaxScalar, maskWeightsScalar, searchScalar},
+#if ANT_KERNELS_X86
+    {"AVX2", KERNELS_AVX2, argmaxAVX2, maskWeightsAVX2, searchAVX2},
+    {"AVX-512", KERNELS_AVX512, argmaxAVX512, maskWeightsAVX512, searchAVX512},
+#endif
+};
+
+static int supportedLevel() {
+    /* Fastest kernels this CPU can run */
+#if ANT_KERNELS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        return KERNELS_AVX512;
+    if (__builtin_cpu_supports("avx2"))
+        return KERNELS_AVX2;
+#endif
+    return KERNELS_SCALAR;
+}
+
+const antKernels& antKernels::select() {
+    /**
+    * -- Return --
+    * Fastest kernels supported by the CPU (checked once)
+    * */
+    static const int level = supportedLevel();
+    return kernelSets[level];
+}
+
+const antKernels& antKernels::select(int level) {
+    /**
+    * -- Parameters --
+    * int level     : KERNELS_SCALAR, KERNELS_AVX2 or KERNELS_AVX512
+    * -- Return --
+    * Given kernels if the CPU supports them, the fastest supported ones otherwise
+    * */
+    int supported = select().level;
+    return kernelSets[(level < KERNELS_SCALAR) ? KERNELS_SCALAR : (level < supported ? level : supported)];
+}
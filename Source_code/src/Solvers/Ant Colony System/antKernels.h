@@ -0,0 +1,32 @@
+#ifndef ANTKERNELS_H
+#define ANTKERNELS_H
+
+/**
+ * @file antKernels.h/cpp
+ * @brief Vectorised (AVX2/AVX-512) loops of the state transition rule, with a scalar fallback chosen at runtime.
+ */
+
+#include "../../Utilities/typesAndDefs.h"
+#include <cstdint>
+
+/*
+ * All kernels work on a whole (padded) row of a flatMatrix: n is the row stride, a multiple of 8, and rows are
+ * 64-byte aligned, so there is no tail to handle. Visited holes are bits set in a mask of (n + 63) / 64 words;
+ * bits of the padding must be set too (padding never holds a hole).
+ * Rows are read with plain loads: no other thread may write them during a call (see sharedRows in Ant.h).
+ */
+struct antKernels {
+    const char* name;
+    int level;
+    // Index of the largest weight among unvisited holes (lowest index on ties), -1 if none is positive
+    int (*argmax)(const double* weights, const uint64_t* visited, int n);
+    // Copy weights to out, with zeros for visited holes. Returns the sum of out
+    double (*maskWeights)(const double* weights, const uint64_t* visited, int n, double* out);
+    // First index where the running sum of weights exceeds target (roulette wheel), -1 if none (rounding)
+    int (*search)(const double* weights, int n, double target);
+
+    static const antKernels& select();              // Fastest kernels supported by this CPU
+    static const antKernels& select(int level);     // Given kernels (KERNELS_*), or the fastest supported below
+};
+
+#endif //ANTKERNELS_H
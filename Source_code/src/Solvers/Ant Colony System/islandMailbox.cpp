@@ -0,0 +1,66 @@
+#include "islandMailbox.h"
+
+/**
+ * @file islandMailbox.h/cpp
+ * @brief Lock-free exchange of best tours between colonies running in parallel (island model).
+ */
+
+islandMailbox::islandMailbox(int _numIslands, int _numHoles) :
+        numIslands(_numIslands), numHoles(_numHoles), slots(new slot[_numIslands])
+{
+    /**
+    * -- Parameters --
+    * int _numIslands   : number of colonies
+    * int _numHoles     : number of holes of the instance (length of every tour)
+    * */
+    for (int i=0; i<numIslands; i++)
+        slots[i].route.reset(new std::atomic<int>[numHoles]());
+}
+
+void islandMailbox::publish(int island, const std::vector<int>& route, double length) {
+    /**
+    * Replace the tour of an island (single writer per slot: wait-free)
+    * -- Parameters --
+    * int island                    : island writing (its own slot)
+    * const std::vector<int>& route : its best tour
+    * double length                 : length of the tour
+    * */
+    slot& s = slots[island];
+    unsigned version = s.version.load(std::memory_order_relaxed);
+    s.version.store(version + 1, std::memory_order_relaxed);
+    // Readers must see the odd version before any of the new values
+    std::atomic_thread_fence(std::memory_order_release);
+    for (int k=0; k<numHoles; k++)
+        s.route[k].store(route[k], std::memory_order_relaxed);
+    s.length.store(length, std::memory_order_relaxed);
+    s.version.store(version + 2, std::memory_order_release);
+}
+
+bool islandMailbox::fetch(int island, std::vector<int>& route, double& length) const {
+    /**
+    * Copy the latest tour of an island (wait-free: gives up instead of retrying)
+    * -- Parameters --
+    * int island                : island read
+    * std::vector<int>& route   : filled with its tour
+    * double& length            : set to the length of the tour
+    * -- Return --
+    * True if a whole tour was copied, false if the slot is empty or was being written meanwhile
+    * */
+    const slot& s = slots[island];
+    unsigned before = s.version.load(std::memory_order_acquire);
+    if (before == 0 || (before & 1u) != 0)
+        return false;
+    route.resize(numHoles);
+    for (int k=0; k<numHoles; k++)
+        route[k] = s.route[k].load(std::memory_order_relaxed);
+    length = s.length.load(std::memory_order_relaxed);
+    // The copy must be complete before the version is checked again
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return s.version.load(std::memory_order_relaxed) == before;
+}
+
+void islandMailbox::clear() {
+    for (int i=0; i<numIslands; i++)
+        slots[i].version.store(0, std::memory_order_relaxed);
+    done.store(false, std::memory_order_relaxed);
+}
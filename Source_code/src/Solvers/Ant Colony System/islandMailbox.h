@@ -0,0 +1,39 @@
+#ifndef ISLANDMAILBOX_H
+#define ISLANDMAILBOX_H
+
+/**
+ * @file islandMailbox.h/cpp
+ * @brief Lock-free exchange of best tours between colonies running in parallel (island model).
+ */
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+/*
+ * One slot per island, written only by its island and read by the others. Each slot is a sequence lock: the
+ * version is odd while the tour is being written, and readers keep a copy only if the version was even and
+ * did not change while they copied. Neither side ever waits: a reader that races a writer simply skips that
+ * migration. Slots hold the tour as relaxed atomics, so concurrent copies are well defined.
+ */
+class islandMailbox {
+public:
+    islandMailbox(int _numIslands, int _numHoles);
+    int size() const { return numIslands; }
+    void publish(int island, const std::vector<int>& route, double length);     // Called by the island only
+    bool fetch(int island, std::vector<int>& route, double& length) const;      // Latest consistent tour of an island
+    void finish() { done.store(true, std::memory_order_relaxed); }             // Ask every island to stop
+    bool finished() const { return done.load(std::memory_order_relaxed); }
+    void clear();                           // Empty every slot (no island may be running)
+private:
+    struct slot {
+        std::atomic<unsigned> version{0};   // 0: empty, odd: being written
+        std::atomic<double> length{0.0};
+        std::unique_ptr<std::atomic<int>[]> route;
+    };
+    int numIslands, numHoles;
+    std::unique_ptr<slot[]> slots;
+    std::atomic<bool> done{false};
+};
+
+#endif //ISLANDMAILBOX_H
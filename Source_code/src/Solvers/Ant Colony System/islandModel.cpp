@@ -0,0 +1,118 @@
+#include "islandModel.h"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <thread>
+
+/**
+ * @file islandModel.h/cpp
+ * @brief Independent ACS colonies running in parallel, exchanging their best tours every few iterations.
+ */
+
+islandModel::islandModel(const std::vector<ACSparameters>& islands, const doubleMap* times, double _sol,
+                         int _interval) : optimalSolution(_sol)
+{
+    /**
+    * -- Parameters --
+    * const std::vector<ACSparameters>& islands : parameters of each island (at least one)
+    * const doubleMap* times                    : distance matrix, shared by the islands
+    * double _sol                               : optimal solution (-1 if unknown)
+    * int _interval                             : iterations between two migrations
+    * */
+    for (const auto& params : islands)
+        colonies.emplace_back(new ACSHeuristic(params, times, _sol, false));
+    connect(_interval);
+}
+
+islandModel::islandModel(const std::vector<ACSparameters>& islands,
+                         const std::deque<std::pair<double,double>>& coordMap, double _sol, int _interval) :
+        optimalSolution(_sol)
+{
+    for (const auto& params : islands)
+        colonies.emplace_back(new ACSHeuristic(params, coordMap, _sol, false));
+    connect(_interval);
+}
+
+std::vector<ACSparameters> islandModel::spread(const ACSparameters& base, int numIslands) {
+    /**
+    * Islands with different greediness explore differently: beta and q_0 are spread linearly over
+    * [beta - ISLAND_BETA_SPREAD/2, beta + ISLAND_BETA_SPREAD/2] and [q_0 - ISLAND_Q0_SPREAD, q_0]
+    * -- Parameters --
+    * const ACSparameters& base : parameters around which the islands are spread
+    * int numIslands            : number of islands
+    * -- Return --
+    * Parameters of each island, each with its own seed (derived from the base seed, if set)
+    * */
+    uint64_t master = (base.seed != 0) ? base.seed
+                      : static_cast<uint64_t>(std::chrono::high_resolution_clock::now().time_since_epoch().count());
+    std::vector<ACSparameters> islands(std::max(1, numIslands), base);
+    for (int i=0; i<static_cast<int>(islands.size()); i++) {
+        double t = (islands.size() > 1) ? static_cast<double>(i) / (islands.size() - 1) : 0.5;
+        islands[i].beta = std::max(1.0, base.beta + (t - 0.5) * ISLAND_BETA_SPREAD);
+        islands[i].greediness = std::max(0.0, base.greediness - t * ISLAND_Q0_SPREAD);
+        // Seed 0 means time-based: keep the island seeds nonzero
+        islands[i].seed = rngStream(master, i).next() | 1u;
+    }
+    return islands;
+}
+
+void islandModel::connect(int interval) {
+    /**
+    * Split the hardware threads between the islands and plug them into a shared mailbox
+    * -- Parameters --
+    * int interval  : iterations between two migrations
+    * */
+    int numIslands = static_cast<int>(colonies.size());
+    int numHoles = static_cast<int>(colonies[0]->getRoute().size());
+    int cores = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    mailbox = std::make_unique<islandMailbox>(numIslands, numHoles);
+    pool = std::make_unique<threadPool>(static_cast<unsigned>(std::min(numIslands, cores)));
+    for (int i=0; i<numIslands; i++) {
+        colonies[i]->setThreads(static_cast<unsigned>(std::max(1, cores / numIslands)));
+        colonies[i]->joinIslands(mailbox.get(), i, interval);
+    }
+}
+
+void islandModel::optimize() {
+    /**
+    * Run every island (one chunk each), then pick the best tour found
+    * */
+    auto start = std::chrono::high_resolution_clock::now();
+    pool->parallelFor(size(), 1, [this](int first, int last, unsigned) {
+        for (int i=first; i<last; i++)
+            colonies[i]->optimize();
+    });
+    bestIsland = 0;
+    for (int i=1; i<size(); i++)
+        if (colonies[i]->getObj() < colonies[bestIsland]->getObj())
+            bestIsland = i;
+    auto end = std::chrono::high_resolution_clock::now();
+    solveTime = std::chrono::duration_cast<std::chrono::milliseconds>(end-start).count();
+}
+
+void islandModel::reset() {
+    /* New run: fresh trails and streams on every island, empty mailbox */
+    mailbox->clear();
+    for (auto& colony : colonies)
+        colony->reset();
+}
+
+void islandModel::printResults() {
+    /**
+    * Print results of optimization
+    * */
+    std::cout << "-- Optimization results (island model) --" << std::endl;
+    for (int i=0; i<size(); i++)
+        std::cout << "    Island " << std::setw(3) << i << "            :      " << colonies[i]->getObj()
+                  << " (" << colonies[i]->getIterations() << " iterations, "
+                  << stoppingRule::describe(colonies[i]->getStopReason()) << ")" << std::endl;
+    std::cout << "    Best island           :      " << bestIsland << std::endl;
+    std::cout << "    Found obj             :      " << getObj() << std::endl;
+    if (optimalSolution != -1) {
+        std::cout << "    Optimal obj           :      " << optimalSolution << std::endl;
+        std::cout << "    This is " << std::setprecision(4) << Utils::percentDifference(getObj(), optimalSolution)
+                  << "% off the optimal solution." << std::endl;
+    }
+    std::cout << "    Optimization took "
+              << solveTime << " milliseconds (" << solveTime/1000.0 << " second(s))."  << std::endl;
+}
@@ -0,0 +1,61 @@
+#ifndef ISLANDMODEL_H
+#define ISLANDMODEL_H
+
+/**
+ * @file islandModel.h/cpp
+ * @brief Independent ACS colonies running in parallel, exchanging their best tours every few iterations.
+ */
+
+#include "../../Utilities/typesAndDefs.h"
+#include "../../Utilities/threadPool.h"
+#include "ACSHeuristic.h"
+#include "islandMailbox.h"
+#include <deque>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// Iterations between two migrations, by default
+#define ISLAND_MIGRATION_INTERVAL 25
+// Range of beta and of q_0 spread over the islands by islandModel::spread
+#define ISLAND_BETA_SPREAD 2.0
+#define ISLAND_Q0_SPREAD 0.1
+
+/*
+ * Each island is a whole ACSHeuristic (own trails, ants, random streams and possibly parameters) run by its own
+ * group of threads: colonies never wait for each other, and the only shared state is the mailbox they
+ * publish their best tours to. The hardware threads are split evenly between the islands (at least one each);
+ * with more islands than threads, islands queue for a thread and migrate with whichever islands are running.
+ * Migrations depend on timing, so runs are not reproducible even with a fixed seed.
+ */
+class islandModel {
+public:
+    // One set of parameters per island (see spread), distances read from a matrix (owned by the caller)
+    islandModel(const std::vector<ACSparameters>& islands, const doubleMap* times, double _sol,
+                int _interval = ISLAND_MIGRATION_INTERVAL);
+    // Distances computed on demand from the coordinates
+    islandModel(const std::vector<ACSparameters>& islands, const std::deque<std::pair<double,double>>& coordMap,
+                double _sol, int _interval = ISLAND_MIGRATION_INTERVAL);
+    // Parameters of numIslands islands: beta and q_0 spread around the base values, one random stream each
+    static std::vector<ACSparameters> spread(const ACSparameters& base, int numIslands);
+
+    void optimize();                        // Run all the islands until each one stops
+    void printResults();
+    void reset();
+    long getTime() { return solveTime; }
+    double getObj() { return colonies[bestIsland]->getObj(); }
+    const std::vector<int>& getRoute() { return colonies[bestIsland]->getRoute(); }
+    int getBestIsland() { return bestIsland; }
+    int size() { return static_cast<int>(colonies.size()); }
+private:
+    void connect(int interval);             // Mailbox, threads and migration of every island
+
+    std::vector<std::unique_ptr<ACSHeuristic>> colonies;
+    std::unique_ptr<islandMailbox> mailbox;
+    std::unique_ptr<threadPool> pool;       // One thread per running island
+    double optimalSolution;
+    int bestIsland = 0;
+    long solveTime = -1;
+};
+
+#endif //ISLANDMODEL_H
@@ -0,0 +1,99 @@
+#include "stoppingRule.h"
+#include <climits>
+#include <string>
+
+/**
+ * @file stoppingRule.h/cpp
+ * @brief When a colony stops: iteration count, time budget, iterations without improvement, target objective.
+ */
+
+stoppingRule::stoppingRule(const ACSparameters& params, double optimalSolution) :
+        maxIterations(params.iterations), stallLimit(params.stallLimit), timeLimit(params.timeLimit),
+        target(params.targetObj)
+{
+    /**
+    * -- Parameters --
+    * const ACSparameters& params   : iterations, timeLimit, stallLimit and targetObj are used
+    * double optimalSolution        : optimal solution given to the solver (-1 if unknown)
+    * */
+    if (target == TARGET_OPTIMAL)
+        target = (optimalSolution > 0) ? optimalSolution : 0.0;
+    else if (target < 0)
+        target = 0.0;
+}
+
+void stoppingRule::start() {
+    startTime = std::chrono::steady_clock::now();
+    lastBest = static_cast<double>(INT_MAX);
+    lastImprovement = 0;
+    iterationsDone = 0;
+    stopReason = (maxIterations > 0) ? STOP_RUNNING : STOP_ITERATIONS;
+}
+
+long stoppingRule::elapsed() const {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+std::chrono::steady_clock::time_point stoppingRule::deadline() const {
+    /**
+    * -- Return --
+    * Time at which the budget of the run (started by start()) runs out, time_point::max() if there is no budget
+    * */
+    if (timeLimit <= 0)
+        return std::chrono::steady_clock::time_point::max();
+    return startTime + std::chrono::milliseconds(timeLimit);
+}
+
+void stoppingRule::update(int iteration, double bestLen) {
+    /**
+    * Record an iteration, and decide whether the run stops
+    * -- Parameters --
+    * int iteration     : iteration just completed (numbered from 0)
+    * double bestLen    : length of the best tour so far
+    * */
+    iterationsDone = iteration + 1;
+    if (bestLen < lastBest) {
+        lastBest = bestLen;
+        lastImprovement = iteration;
+    }
+    if (target > 0 && bestLen <= target * (1 + TARGET_TOLERANCE))
+        stopReason = STOP_TARGET;
+    else if (stallLimit > 0 && iteration - lastImprovement >= stallLimit)
+        stopReason = STOP_STALL;
+    else if (timeLimit > 0 && elapsed() >= timeLimit)
+        stopReason = STOP_TIME_LIMIT;
+    else if (iterationsDone >= maxIterations)
+        stopReason = STOP_ITERATIONS;
+}
+
+void stoppingRule::print() const {
+    /* Criteria in use, on one line */
+    std::cout << maxIterations << " iterations";
+    if (timeLimit > 0)
+        std::cout << ", " << timeLimit << " ms";
+    if (stallLimit > 0)
+        std::cout << ", " << stallLimit << " iterations without improvement";
+    if (target > 0)
+        std::cout << ", target obj " << target;
+}
+
+const char* stoppingRule::describe(int reason) {
+    /**
+    * -- Parameters --
+    * int reason    : STOP_* value
+    * -- Return --
+    * Name of the criterion
+    * */
+    switch (reason) {
+        case STOP_ITERATIONS:
+            return "Iteration count";
+        case STOP_TIME_LIMIT:
+            return "Time limit";
+        case STOP_STALL:
+            return "No improvement";
+        case STOP_TARGET:
+            return "Target objective";
+        default:
+            return "Still running";
+    }
+}
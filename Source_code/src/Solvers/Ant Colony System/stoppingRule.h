@@ -0,0 +1,40 @@
+#ifndef STOPPINGRULE_H
+#define STOPPINGRULE_H
+
+/**
+ * @file stoppingRule.h/cpp
+ * @brief When a colony stops: iteration count, time budget, iterations without improvement, target objective.
+ */
+
+#include "../../Utilities/typesAndDefs.h"
+#include <chrono>
+
+/*
+ * Checked once per iteration, after the best tour has been updated: a run may overshoot the time budget by one
+ * iteration (chained LK polishing the final tour, by one kick: see deadline). When several criteria hold at once, the reported one is the first of target, stall, time limit and
+ * iteration count.
+ */
+class stoppingRule {
+public:
+    stoppingRule() = default;
+    stoppingRule(const ACSparameters& params, double optimalSolution);
+    void start();                           // Start of a run: clock, stall counter
+    void update(int iteration, double bestLen);     // After an iteration (numbered from 0)
+    void halt(int reason) { stopReason = reason; }  // Stop for an outside reason (e.g. another island)
+    bool stopped() const { return stopReason != STOP_RUNNING; }
+    int reason() const { return stopReason; }       // STOP_* value
+    int iterationsRun() const { return iterationsDone; }
+    long elapsed() const;                   // Milliseconds since start()
+    std::chrono::steady_clock::time_point deadline() const;    // End of the time budget (max() without one)
+    void print() const;                     // Criteria in use
+    static const char* describe(int reason);
+private:
+    int maxIterations = 0, stallLimit = 0;
+    long timeLimit = 0;
+    double target = 0.0;                    // Target objective (0: none)
+    std::chrono::steady_clock::time_point startTime;
+    double lastBest = 0.0;
+    int lastImprovement = 0, iterationsDone = 0, stopReason = STOP_RUNNING;
+};
+
+#endif //STOPPINGRULE_H
@@ -0,0 +1,51 @@
+#ifndef DONTLOOKQUEUE_H
+#define DONTLOOKQUEUE_H
+
+/**
+ * @file dontLookQueue.h
+ * @brief Don't-look bits of the local search operators, kept as a FIFO queue of the holes whose bit is off.
+ */
+
+#include <vector>
+
+class dontLookQueue {
+public:
+    void init(int _n) {
+        numHoles = _n;
+        holes.assign(numHoles, 0);
+        queued.assign(numHoles, false);
+        head = count = 0;
+    }
+    void reset(const std::vector<int>& tour) {
+        /* Every hole starts with its don't-look bit off, in tour order */
+        head = count = 0;
+        for (int hole : tour)
+            queued[hole] = false;
+        for (int hole : tour)
+            push(hole);
+    }
+    void push(int hole) {
+        /* Turn the don't-look bit of a hole off (no-op if it is already waiting) */
+        if (queued[hole])
+            return;
+        queued[hole] = true;
+        holes[(head + count) % numHoles] = hole;
+        count++;
+    }
+    int pop() {
+        /* Next hole to look at (its don't-look bit is set until it is pushed again) */
+        int hole = holes[head];
+        head = (head + 1) % numHoles;
+        count--;
+        queued[hole] = false;
+        return hole;
+    }
+    bool empty() const { return count == 0; }
+private:
+    int numHoles = 0;
+    std::vector<int> holes;                 // Circular buffer (each hole is queued at most once)
+    std::vector<bool> queued;
+    int head = 0, count = 0;
+};
+
+#endif //DONTLOOKQUEUE_H
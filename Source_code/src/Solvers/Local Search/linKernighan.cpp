@@ -0,0 +1,269 @@
+#include "linKernighan.h"
+#include <algorithm>
+#include <limits>
+
+/**
+ * @file linKernighan.h/cpp
+ * @brief Lin-Kernighan style k-opt improvement (sequences of 2-opt flips) and chained Lin-Kernighan.
+ */
+
+template <typename Index>
+void linKernighan<Index>::init(int _n, const distanceProvider* _dist, const intMap* _neigh) {
+    /**
+    * -- Parameters --
+    * int _n                        : number of holes of the instance
+    * const distanceProvider* _dist : (symmetric) distances
+    * const intMap* _neigh          : nearest holes of each hole, by increasing distance
+    * */
+    numHoles = _n;
+    distances = _dist;
+    neighbours = _neigh;
+    queue.init(numHoles);
+}
+
+template <typename Index>
+double linKernighan<Index>::improve(std::vector<int>& tour) {
+    /**
+    * Apply LK moves until none improves the tour
+    * -- Parameters --
+    * std::vector<int>& tour    : closed tour, improved in place
+    * -- Return --
+    * Change of the tour length (zero or negative)
+    * */
+    if (numHoles < LK_MIN_HOLES)
+        return 0.0;
+    load(tour);
+    double delta = optimize(tour);
+    store(tour);
+    return delta;
+}
+
+template <typename Index>
+double linKernighan<Index>::optimize(const std::vector<int>& order) {
+    /**
+    * Apply LK moves to the loaded tour until none improves it (the tour is read back with store)
+    * -- Parameters --
+    * const std::vector<int>& order : every hole, in the order they are first looked at
+    * -- Return --
+    * Change of the tour length (zero or negative)
+    * */
+    if (numHoles < LK_MIN_HOLES)
+        return 0.0;
+    queue.reset(order);
+    flips.clear();
+    double delta = optimizeQueue();
+    flips.clear();
+    return delta;
+}
+
+template <typename Index>
+double linKernighan<Index>::chained(std::vector<int>& tour, int kicks, rngStream& rng, lkDeadline deadline) {
+    /**
+    * Chained LK: after a first LK descent, repeatedly perturb the tour with a kick (a local double bridge, which
+    * LK cannot undo with sequential flips), repair it with LK around the kick, and keep the result only if the
+    * tour got shorter. Only the holes near the kick are looked at again, so each kick costs little.
+    * The deadline is checked before the first descent and between kicks: a kick in progress always completes.
+    * -- Parameters --
+    * std::vector<int>& tour    : closed tour, improved in place
+    * int kicks                 : number of kicks
+    * rngStream& rng            : random stream choosing the kicks
+    * lkDeadline deadline       : no kick starts after this time (LK_NO_DEADLINE: all kicks are done)
+    * -- Return --
+    * Change of the tour length (zero or negative)
+    * */
+    bool timed = deadline != LK_NO_DEADLINE;
+    if (numHoles < LK_MIN_HOLES || (timed && std::chrono::steady_clock::now() >= deadline))
+        return 0.0;
+    load(tour);
+    double delta = optimize(tour);
+    for (int k=0; k<kicks && !(timed && std::chrono::steady_clock::now() >= deadline); k++) {
+        flips.clear();
+        double change = kick(rng);
+        change += optimizeQueue();
+        if (change < -LS_EPSILON)
+            delta += change;
+        else
+            undoTo(0);
+    }
+    flips.clear();
+    store(tour);
+    return delta;
+}
+
+template <typename Index>
+void linKernighan<Index>::move(int b, int c, bool mirrored) {
+    /* In the mirrored direction, the path from b to c goes from c to b */
+    if (mirrored)
+        std::swap(b, c);
+    list.flip(b, c);
+    flips.emplace_back(b, c);
+}
+
+template <typename Index>
+void linKernighan<Index>::undoTo(std::size_t mark) {
+    /* After flip(b, c), the path goes from c to b: flipping it again restores the tour */
+    while (flips.size() > mark) {
+        list.flip(flips.back().second, flips.back().first);
+        flips.pop_back();
+    }
+}
+
+template <typename Index>
+bool linKernighan<Index>::isAdded(int a, int b) const {
+    for (const auto& edge : added)
+        if ((edge.first == a && edge.second == b) || (edge.first == b && edge.second == a))
+            return true;
+    return false;
+}
+
+template <typename Index>
+double linKernighan<Index>::optimizeQueue() {
+    /**
+    * Look for an improving move from every hole whose don't-look bit is off, until there is none
+    * -- Return --
+    * Change of the tour length (zero or negative)
+    * */
+    double delta = 0.0;
+    while (!queue.empty()) {
+        int t1 = queue.pop();
+        double change = stepFrom(t1, false);
+        // Break the other tour edge of t1
+        if (change == 0.0)
+            change = stepFrom(t1, true);
+        delta += change;
+    }
+    return delta;
+}
+
+template <typename Index>
+double linKernighan<Index>::stepFrom(int t1, bool mirrored) {
+    /**
+    * LK move starting with the removal of edge (t1, t2 = succ(t1)). Each step adds an edge (t2, t3) with t3 among
+    * the neighbours of t2 and removes (t4 = pred(t3), t3) with a flip, so that the tour closes with (t1, t4); the
+    * next step starts from t4. Steps go on while the partial gain stays positive, and the move is cut back to the
+    * step with the best closed tour. The first added edge tries LK_BREADTH alternatives, later ones are greedy.
+    * -- Parameters --
+    * int t1            : starting hole
+    * bool mirrored     : walk the tour backwards (i.e. remove the edge (pred(t1), t1))
+    * -- Return --
+    * Change of the tour length (zero if no improving move was found, and the tour is left untouched)
+    * */
+    int t2 = succ(t1, mirrored), s2 = succ(t2, mirrored);
+    double removed = d(t1, t2);
+    // First added edge: most promising alternatives first (gain including the edge removed next)
+    std::pair<double, int> options[LK_BREADTH];
+    int numOptions = 0;
+    for (int t3 : (*neighbours)[t2]) {
+        double gain = removed - d(t2, t3);
+        if (gain <= LS_EPSILON)
+            break;
+        if (t3 == t1 || t3 == s2)
+            continue;
+        std::pair<double, int> option(gain + d(t3, pred(t3, mirrored)), t3);
+        if (numOptions == LK_BREADTH && option.first <= options[numOptions - 1].first)
+            continue;
+        // Insertion in the (short) sorted list of options
+        int k = (numOptions < LK_BREADTH) ? numOptions++ : numOptions - 1;
+        for (; k > 0 && options[k - 1].first < option.first; k--)
+            options[k] = options[k - 1];
+        options[k] = option;
+    }
+    for (int o=0; o<numOptions; o++) {
+        int t3 = options[o].second, t4 = pred(t3, mirrored);
+        std::size_t mark = flips.size(), bestMark = mark;
+        double bestGain = LS_EPSILON;
+        added.clear();
+        touched.assign({t1, t2, t3, t4});
+        move(t2, t4, mirrored);
+        added.emplace_back(t2, t3);
+        double gain = removed - d(t2, t3) + d(t3, t4);
+        if (gain - d(t1, t4) > bestGain) {
+            bestGain = gain - d(t1, t4);
+            bestMark = flips.size();
+        }
+        deepen(t1, t4, gain, bestGain, bestMark, mirrored);
+        undoTo(bestMark);
+        if (bestMark > mark) {
+            for (int hole : touched)
+                queue.push(hole);
+            return -bestGain;
+        }
+    }
+    return 0.0;
+}
+
+template <typename Index>
+void linKernighan<Index>::deepen(int t1, int t2, double gain, double& bestGain, std::size_t& bestMark, bool mirrored) {
+    /**
+    * Greedy steps of an LK move, up to LK_MAX_DEPTH flips
+    * -- Parameters --
+    * int t1                : starting hole of the move
+    * int t2                : hole the next added edge starts from (succ(t1) in the current tour)
+    * double gain           : removed minus added length so far (without the closing edge)
+    * double& bestGain      : best gain of a closed tour so far, updated
+    * std::size_t& bestMark : number of logged flips giving that tour, updated
+    * bool mirrored         : direction of the move
+    * */
+    for (int depth=1; depth<LK_MAX_DEPTH; depth++) {
+        int s2 = succ(t2, mirrored), bestT3 = -1;
+        double bestScore = -std::numeric_limits<double>::max();
+        for (int t3 : (*neighbours)[t2]) {
+            double partial = gain - d(t2, t3);
+            if (partial <= LS_EPSILON)
+                break;
+            if (t3 == t1 || t3 == s2)
+                continue;
+            int t4 = pred(t3, mirrored);
+            if (isAdded(t3, t4))
+                continue;
+            if (partial + d(t3, t4) > bestScore) {
+                bestScore = partial + d(t3, t4);
+                bestT3 = t3;
+            }
+        }
+        if (bestT3 == -1)
+            return;
+        int t4 = pred(bestT3, mirrored);
+        move(t2, t4, mirrored);
+        added.emplace_back(t2, bestT3);
+        touched.push_back(bestT3);
+        touched.push_back(t4);
+        gain = bestScore;
+        t2 = t4;
+        if (gain - d(t1, t2) > bestGain) {
+            bestGain = gain - d(t1, t2);
+            bestMark = flips.size();
+        }
+    }
+}
+
+template <typename Index>
+double linKernighan<Index>::kick(rngStream& rng) {
+    /**
+    * Swap two short consecutive segments B and C (tour A B C D becomes A C B D), with three flips
+    * -- Parameters --
+    * rngStream& rng    : random stream choosing the segments
+    * -- Return --
+    * Change of the tour length
+    * */
+    int maxLength = std::min(LK_KICK_SEGMENT, (numHoles - 2) / 2);
+    int p = rng.nextInt(numHoles);
+    int b1 = list.next(p), b2 = b1;
+    for (int i = rng.nextInt(maxLength); i > 0; i--)
+        b2 = list.next(b2);
+    int c1 = list.next(b2), c2 = c1;
+    for (int i = rng.nextInt(maxLength); i > 0; i--)
+        c2 = list.next(c2);
+    int q = list.next(c2);
+    double change = d(p, c1) + d(c2, b1) + d(b2, q) - d(p, b1) - d(b2, c1) - d(c2, q);
+    move(b1, c2, false);        // p c2..c1 b2..b1 q
+    move(c2, c1, false);        // p c1..c2 b2..b1 q
+    move(b2, b1, false);        // p c1..c2 b1..b2 q
+    for (int hole : {p, b1, b2, c1, c2, q})
+        queue.push(hole);
+    return change;
+}
+
+// Instantiated for the two index widths (see twoLevelList.h)
+template class linKernighan<uint16_t>;
+template class linKernighan<uint32_t>;
@@ -0,0 +1,65 @@
+#ifndef LINKERNIGHAN_H
+#define LINKERNIGHAN_H
+
+/**
+ * @file linKernighan.h/cpp
+ * @brief Lin-Kernighan style k-opt improvement (sequences of 2-opt flips) and chained Lin-Kernighan.
+ */
+
+#include "../../Utilities/typesAndDefs.h"
+#include "../../Utilities/rng.h"
+#include "../../Utilities/distanceProvider.h"
+#include "dontLookQueue.h"
+#include "twoLevelList.h"
+#include <chrono>
+#include <utility>
+#include <vector>
+
+// Maximum number of flips in one LK move
+#define LK_MAX_DEPTH 50
+// Alternatives tried for the first added edge of a move (deeper levels are greedy)
+#define LK_BREADTH 3
+// Longest segment swapped by a kick (double bridge) of chained LK
+#define LK_KICK_SEGMENT 50
+// Smallest instance handled
+#define LK_MIN_HOLES 8
+
+// Time by which chained LK stops kicking (default: none)
+typedef std::chrono::steady_clock::time_point lkDeadline;
+#define LK_NO_DEADLINE lkDeadline::max()
+
+// Index: integer type of the tour links (see twoLevelList)
+template <typename Index>
+class linKernighan {
+public:
+    void init(int _n, const distanceProvider* _dist, const intMap* _neigh);
+    void load(const std::vector<int>& tour) { list.build(tour); }
+    void store(std::vector<int>& tour) const { list.toVector(tour, tour[0]); }
+    twoLevelList<Index>& route() { return list; }                       // Loaded tour (other operators may change it)
+    double optimize(const std::vector<int>& order);                     // LK on the loaded tour
+    double improve(std::vector<int>& tour);                             // LK until no improving move is left
+    // Chained LK: kick, repair, keep if shorter (until kicks are done, or the deadline has passed)
+    double chained(std::vector<int>& tour, int kicks, rngStream& rng, lkDeadline deadline = LK_NO_DEADLINE);
+private:
+    double d(int a, int b) const { return (*distances)(a, b); }
+    int succ(int a, bool mirrored) const { return mirrored ? list.prev(a) : list.next(a); }
+    int pred(int a, bool mirrored) const { return mirrored ? list.next(a) : list.prev(a); }
+    void move(int b, int c, bool mirrored);     // Reverse the path b..c (as seen in the given direction), logged
+    void undoTo(std::size_t mark);              // Undo the logged flips after mark
+    bool isAdded(int a, int b) const;
+    double stepFrom(int t1, bool mirrored);
+    void deepen(int t1, int t2, double gain, double& bestGain, std::size_t& bestMark, bool mirrored);
+    double optimizeQueue();
+    double kick(rngStream& rng);
+
+    int numHoles = 0;
+    const distanceProvider* distances = nullptr;
+    const intMap* neighbours = nullptr;
+    twoLevelList<Index> list;                   // Tour being improved
+    dontLookQueue queue;
+    std::vector<std::pair<int, int>> flips;     // Flips applied since the last checkpoint (to undo them)
+    std::vector<std::pair<int, int>> added;     // Edges added by the current move (never removed again by it)
+    std::vector<int> touched;                   // Ends of the edges changed by the current move
+};
+
+#endif //LINKERNIGHAN_H
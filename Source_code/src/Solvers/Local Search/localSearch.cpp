@@ -0,0 +1,299 @@
+#include "localSearch.h"
+#include "../../Utilities/kdTree.h"
+#include <algorithm>
+
+/**
+ * @file localSearch.h/cpp
+ * @brief Local search operators improving complete tours (in place), used on top of the heuristics.
+ */
+
+void localSearch::init(int _n, const distanceProvider* _dist, const intMap* _neigh) {
+    /**
+    * Allocate the work buffers (once: they are reused for every tour)
+    * -- Parameters --
+    * int _n                        : number of holes of the instance
+    * const distanceProvider* _dist : (symmetric) distances
+    * const intMap* _neigh          : nearest holes of each hole, by increasing distance
+    * */
+    numHoles = _n;
+    distances = _dist;
+    neighbours = _neigh;
+    queue.init(numHoles);
+    if (shortLinks())
+        shortLK.init(numHoles, distances, neighbours);
+    else
+        longLK.init(numHoles, distances, neighbours);
+}
+
+void localSearch::nearestHoles(const distanceProvider& dist, int k, intMap& lists, threadPool* pool) {
+    /**
+    * Find the k nearest holes of each hole (neighbour/candidate lists). With coordinates, a k-d tree answers
+    * in O(n log n); a matrix is scanned row by row. Ties go to the lowest index either way, so both give the
+    * same lists.
+    * -- Parameters --
+    * const distanceProvider& dist : distances
+    * int k                         : number of holes in each list (at most numHoles-1)
+    * intMap& lists                 : lists[i] = the nearest holes of hole i, by increasing distance
+    * threadPool* pool              : workers sharing the holes (nullptr: calling thread only)
+    * */
+    int n = dist.size();
+    k = std::min(k, n - 1);
+    if (dist.onDemand()) {
+        kdTree(dist.xCoordinates(), dist.yCoordinates()).nearest(k, dist.metricMode(), lists, pool);
+        return;
+    }
+    lists.resize(n);
+    auto scan = [&dist, &lists, n, k](int first, int last, unsigned) {
+        std::vector<int> others(n - 1);
+        std::vector<double> row(n);
+        for (int i=first; i<last; i++){
+            dist.row(i, row.data());
+            // All holes but i itself
+            int idx = 0;
+            for (int j=0; j<n; j++)
+                if (j != i)
+                    others[idx++] = j;
+            auto closer = [&row](int a, int b) { return row[a] < row[b] || (row[a] == row[b] && a < b); };
+            std::partial_sort(others.begin(), others.begin() + k, others.end(), closer);
+            lists[i].assign(others.begin(), others.begin() + k);
+        }
+    };
+    if (pool == nullptr)
+        scan(0, n, 0);
+    else
+        pool->parallelFor(n, pool->chunkFor(n), scan);
+}
+
+double localSearch::nearestNeighbourTour(const distanceProvider& dist, const intMap& neigh, int start,
+                                         std::vector<int>& tour) {
+    /**
+    * Build a starting tour by always moving to the nearest unvisited hole (lets chained LK run on its own)
+    * -- Parameters --
+    * const distanceProvider& dist : distances
+    * const intMap& neigh           : nearest holes of each hole, by increasing distance (checked first)
+    * int start                     : first hole
+    * std::vector<int>& tour        : filled with the tour
+    * -- Return --
+    * Length of the tour
+    * */
+    int n = static_cast<int>(dist.size());
+    std::vector<bool> visited(n, false);
+    tour.resize(n);
+    tour[0] = start;
+    visited[start] = true;
+    double length = 0.0;
+    for (int i=1; i<n; i++) {
+        int current = tour[i - 1], best = -1;
+        for (int j : neigh[current]) {
+            if (!visited[j]) {
+                best = j;
+                break;
+            }
+        }
+        // Every neighbour has been visited: look at all the holes
+        if (best == -1) {
+            for (int j=0; j<n; j++)
+                if (!visited[j] && (best == -1 || dist(current, j) < dist(current, best)))
+                    best = j;
+        }
+        tour[i] = best;
+        visited[best] = true;
+        length += dist(current, best);
+    }
+    return length + dist(tour[n - 1], start);
+}
+
+double localSearch::improve(std::vector<int>& tour, int mode) {
+    /**
+    * Improve a tour with the operators selected in mode, until none of them finds an improving move
+    * -- Parameters --
+    * std::vector<int>& tour    : closed tour (the edge from the last hole back to the first is implied)
+    * int mode                  : LOCAL_SEARCH_* flags
+    * -- Return --
+    * Change of the tour length (zero or negative)
+    * */
+    if (numHoles < 5 || mode == LOCAL_SEARCH_NONE)
+        return 0.0;
+    return shortLinks() ? improveWith(shortLK, tour, mode) : improveWith(longLK, tour, mode);
+}
+
+double localSearch::chainedLK(std::vector<int>& tour, int kicks, rngStream& rng, lkDeadline deadline) {
+    /**
+    * -- Parameters --
+    * std::vector<int>& tour    : closed tour, improved in place
+    * int kicks                 : number of kicks
+    * rngStream& rng            : random stream choosing the kicks
+    * lkDeadline deadline       : no kick starts after this time (see linKernighan::chained)
+    * -- Return --
+    * Change of the tour length (zero or negative)
+    * */
+    return shortLinks() ? shortLK.chained(tour, kicks, rng, deadline) : longLK.chained(tour, kicks, rng, deadline);
+}
+
+template <typename Index>
+double localSearch::improveWith(linKernighan<Index>& lk, std::vector<int>& tour, int mode) {
+    /**
+    * The tour is loaded in the list of lk once, improved there by every operator, and written back once
+    * -- Parameters --
+    * linKernighan<Index>& lk   : LK operator owning the list
+    * std::vector<int>& tour    : closed tour, improved in place
+    * int mode                  : LOCAL_SEARCH_* flags
+    * -- Return --
+    * Change of the tour length (zero or negative)
+    * */
+    lk.load(tour);
+    twoLevelList<Index>& route = lk.route();
+    double delta = 0.0;
+    if (mode & LOCAL_SEARCH_2OPT)
+        delta += twoOpt(route, tour);
+    if (mode & LOCAL_SEARCH_OROPT) {
+        // Alternate the operators while Or-opt keeps opening new 2-opt moves
+        while (true) {
+            double gain = orOpt(route, tour);
+            delta += gain;
+            if (gain == 0.0 || !(mode & LOCAL_SEARCH_2OPT))
+                break;
+            gain = twoOpt(route, tour);
+            delta += gain;
+            if (gain == 0.0)
+                break;
+        }
+    }
+    if (mode & LOCAL_SEARCH_LK)
+        delta += lk.optimize(tour);
+    lk.store(tour);
+    return delta;
+}
+
+template <typename Index>
+double localSearch::twoOpt(twoLevelList<Index>& route, const std::vector<int>& order) {
+    /**
+    * 2-opt: replace two edges (t1,t2), (t3,t4) with (t1,t3), (t2,t4) whenever that shortens the tour.
+    * Only moves where t3 is among the nearest holes of t1 are tried (neighbour lists are sorted, so the
+    * scan stops as soon as d(t1,t3) >= d(t1,t2): no improving move can follow). Holes whose neighbourhood
+    * gave no improving move get their don't-look bit set, and are only looked at again once one of their
+    * tour edges changes.
+    * -- Parameters --
+    * twoLevelList<Index>& route        : closed tour, improved in place
+    * const std::vector<int>& order     : every hole, in the order they are first looked at
+    * -- Return --
+    * Change of the tour length (zero or negative), so that callers can update it without a full recount
+    * */
+    double delta = 0.0;
+    queue.reset(order);
+    while (!queue.empty()) {
+        int t1 = queue.pop();
+        bool improved = false;
+        // Both tour edges of t1: (t1, next) and (prev, t1)
+        for (int direction=0; direction<2 && !improved; direction++) {
+            bool forward = (direction == 0);
+            int t2 = forward ? route.next(t1) : route.prev(t1);
+            double removed = d(t1, t2);
+            for (int t3 : (*neighbours)[t1]) {
+                double added = d(t1, t3);
+                if (added >= removed)
+                    break;
+                int t4 = forward ? route.next(t3) : route.prev(t3);
+                if (t3 == t2 || t4 == t1)
+                    continue;
+                double gain = removed + d(t3, t4) - added - d(t2, t4);
+                if (gain > LS_EPSILON) {
+                    // Forward: reverse t2..t3. Backward: the same move seen from the other side, reverse t1..t4
+                    if (forward)
+                        route.flip(t2, t3);
+                    else
+                        route.flip(t1, t4);
+                    delta -= gain;
+                    for (int hole : {t1, t2, t3, t4})
+                        queue.push(hole);
+                    improved = true;
+                    break;
+                }
+            }
+        }
+    }
+    return delta;
+}
+
+template <typename Index>
+double localSearch::orOpt(twoLevelList<Index>& route, const std::vector<int>& order) {
+    /**
+    * Or-opt: move a segment of 1 to OR_OPT_MAX_SEGMENT consecutive holes between two other adjacent holes,
+    * possibly reversed, whenever that shortens the tour. Segments starting or ending at a hole are only looked
+    * at while its don't-look bit is off; new positions are searched among the neighbours of the segment ends.
+    * -- Parameters --
+    * twoLevelList<Index>& route        : closed tour, improved in place
+    * const std::vector<int>& order     : every hole, in the order they are first looked at
+    * -- Return --
+    * Change of the tour length (zero or negative)
+    * */
+    double delta = 0.0;
+    // At least three other holes, so that the segment has somewhere else to go
+    int maxLength = std::min(OR_OPT_MAX_SEGMENT, numHoles - 3);
+    queue.reset(order);
+    while (!queue.empty()) {
+        int hole = queue.pop();
+        bool improved = false;
+        // Segment starting at the hole, then (if longer than one hole) segment ending at it
+        int last = hole, first = hole;
+        for (int length=1; length<=maxLength && !improved; length++) {
+            if (length > 1) {
+                last = route.next(last);
+                first = route.prev(first);
+            }
+            improved = tryMoveSegment(route, hole, last, delta)
+                       || (length > 1 && tryMoveSegment(route, first, hole, delta));
+        }
+    }
+    return delta;
+}
+
+template <typename Index>
+bool localSearch::tryMoveSegment(twoLevelList<Index>& route, int s1, int s2, double& delta) {
+    /**
+    * Look for an improving new position of a segment, and move it there (first improvement)
+    * -- Parameters --
+    * twoLevelList<Index>& route    : tour being improved
+    * int s1, int s2                : first and last holes of the segment
+    * double& delta                 : change of the tour length, updated if the segment is moved
+    * -- Return --
+    * True if the segment was moved
+    * */
+    int before = route.prev(s1), after = route.next(s2);
+    // Gain of taking the segment out (and closing the gap)
+    double removed = d(before, s1) + d(s2, after) - d(before, after);
+    if (removed <= LS_EPSILON)
+        return false;
+    for (int end : {s1, s2}) {
+        int other = (end == s1) ? s2 : s1;
+        for (int c : (*neighbours)[end]) {
+            double joined = d(end, c);
+            if (joined >= removed)
+                break;
+            if (route.between(s1, c, s2))
+                continue;
+            // Insert between c and one of its tour neighbours x, with "end" next to c
+            for (int side=0; side<2; side++) {
+                int x = (side == 0) ? route.next(c) : route.prev(c);
+                if (route.between(s1, x, s2))
+                    continue;
+                double gain = removed - joined - d(other, x) + d(c, x);
+                if (gain > LS_EPSILON) {
+                    // Forward, the segment goes after u: reversed if u is joined to s2
+                    int u = (side == 0) ? c : x;
+                    bool reversed = (side == 0) ? (end == s2) : (end == s1);
+                    // before s1..s2 after .. u v  ->  before u .. after s2..s1 v  ->  before after .. u s2..s1 v
+                    route.flip(s1, u);
+                    route.flip(u, after);
+                    if (!reversed)
+                        route.flip(s2, s1);
+                    delta -= gain;
+                    for (int hole : {before, after, s1, s2, c, x})
+                        queue.push(hole);
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
@@ -0,0 +1,51 @@
+#ifndef LOCALSEARCH_H
+#define LOCALSEARCH_H
+
+/**
+ * @file localSearch.h/cpp
+ * @brief Local search operators improving complete tours (in place), used on top of the heuristics.
+ */
+
+#include "../../Utilities/typesAndDefs.h"
+#include "../../Utilities/rng.h"
+#include "../../Utilities/distanceProvider.h"
+#include "../../Utilities/threadPool.h"
+#include "dontLookQueue.h"
+#include "linKernighan.h"
+#include <vector>
+
+// Longest segment moved by Or-opt
+#define OR_OPT_MAX_SEGMENT 3
+
+// Holds the work buffers of the operators: one object per thread/ant, reused for every tour.
+// All operators assume symmetric distances. Tours are improved on a two-level list (O(1) next/prev/between,
+// O(sqrt(n)) reversals), with 16-bit links up to TWO_LEVEL_MAX_SHORT holes and 32-bit links beyond.
+class localSearch {
+public:
+    localSearch() : numHoles(0), distances(nullptr), neighbours(nullptr) {}
+    void init(int _n, const distanceProvider* _dist, const intMap* _neigh);
+    double improve(std::vector<int>& tour, int mode);      // Apply the operators selected in mode
+    double chainedLK(std::vector<int>& tour, int kicks, rngStream& rng, lkDeadline deadline = LK_NO_DEADLINE);
+    // k nearest holes of each hole (spatial index if distances come from coordinates)
+    static void nearestHoles(const distanceProvider& dist, int k, intMap& lists, threadPool* pool = nullptr);
+    static double nearestNeighbourTour(const distanceProvider& dist, const intMap& neigh, int start,
+                                       std::vector<int>& tour);
+private:
+    bool shortLinks() const { return numHoles <= TWO_LEVEL_MAX_SHORT; }
+    double d(int a, int b) { return (*distances)(a, b); }
+    template <typename Index> double improveWith(linKernighan<Index>& lk, std::vector<int>& tour, int mode);
+    // 2-opt with neighbour lists and don't-look bits
+    template <typename Index> double twoOpt(twoLevelList<Index>& route, const std::vector<int>& order);
+    // Or-opt: move segments of 1 to OR_OPT_MAX_SEGMENT holes
+    template <typename Index> double orOpt(twoLevelList<Index>& route, const std::vector<int>& order);
+    template <typename Index> bool tryMoveSegment(twoLevelList<Index>& route, int s1, int s2, double& delta);
+
+    int numHoles;
+    const distanceProvider* distances;
+    const intMap* neighbours;               // Nearest holes of each hole, sorted by distance
+    dontLookQueue queue;                    // Holes whose neighbourhood may hold an improving move
+    linKernighan<uint16_t> shortLK;         // Owns the tour list (only the one matching numHoles is initialised)
+    linKernighan<uint32_t> longLK;
+};
+
+#endif //LOCALSEARCH_H
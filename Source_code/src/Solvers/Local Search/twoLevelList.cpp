@@ -0,0 +1,366 @@
+#include "twoLevelList.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+/**
+ * @file twoLevelList.h/cpp
+ * @brief Tour stored as a two-level doubly-linked list: O(1) next/prev/between, O(sqrt(n)) reversals.
+ */
+
+template <typename Index>
+constexpr Index twoLevelList<Index>::none;
+
+template <typename Index>
+void twoLevelList<Index>::build(const std::vector<int>& tour) {
+    /**
+    * Load a tour, cut into segments of groupSize consecutive holes
+    * -- Parameters --
+    * const std::vector<int>& tour  : tour[i] = i-th hole of the tour
+    * */
+    numHoles = static_cast<int>(tour.size());
+    // About sqrt(n) holes per segment, and at least four segments (small tours: a single segment)
+    groupSize = (numHoles < 8) ? std::max(1, numHoles)
+              : std::max(2, std::min(static_cast<int>(std::sqrt(static_cast<double>(numHoles))), numHoles / 4));
+    numSegments = (numHoles + groupSize - 1) / groupSize;
+    rawNext.resize(numHoles);
+    rawPrev.resize(numHoles);
+    parent.resize(numHoles);
+    seq.resize(numHoles);
+    segments.assign(numSegments, segment{-1, -1, 0, 0, false});
+    order.resize(numSegments);
+    for (int s=0; s<numSegments; s++) {
+        segments[s].rank = s;
+        order[s] = s;
+    }
+    for (int i=0; i<numHoles; i++) {
+        int a = tour[i], s = i / groupSize;
+        bool head = (i % groupSize == 0), tail = (i % groupSize == groupSize - 1 || i == numHoles - 1);
+        parent[a] = static_cast<Index>(s);
+        seq[a] = i;
+        rawPrev[a] = head ? none : static_cast<Index>(tour[i - 1]);
+        rawNext[a] = tail ? none : static_cast<Index>(tour[i + 1]);
+        if (head)
+            segments[s].first = a;
+        segments[s].last = a;
+        segments[s].size++;
+    }
+    reversed = false;
+    unbalanced = false;
+}
+
+template <typename Index>
+void twoLevelList<Index>::rebuild() {
+    /* Cut the current tour into segments of groupSize holes again (O(n)) */
+    std::vector<int> tour(numHoles);
+    int a = headOf(order[0]);
+    for (int i=0; i<numHoles; i++) {
+        tour[i] = a;
+        a = forward(a);
+    }
+    bool wasReversed = reversed;
+    build(tour);
+    reversed = wasReversed;
+}
+
+template <typename Index>
+void twoLevelList<Index>::toVector(std::vector<int>& tour, int start) const {
+    /**
+    * Write the tour in a vector
+    * -- Parameters --
+    * std::vector<int>& tour    : filled with the holes of the tour, in order
+    * int start                 : hole written in tour[0]
+    * */
+    tour.resize(numHoles);
+    int a = start;
+    for (int i=0; i<numHoles; i++) {
+        tour[i] = a;
+        a = next(a);
+    }
+}
+
+template <typename Index>
+int twoLevelList<Index>::forward(int a) const {
+    const segment& s = segments[parent[a]];
+    Index b = s.reversed ? rawPrev[a] : rawNext[a];
+    // Last hole of the segment: go to the head of the next segment
+    return (b != none) ? b : headOf(order[(s.rank + 1) % numSegments]);
+}
+
+template <typename Index>
+int twoLevelList<Index>::backward(int a) const {
+    const segment& s = segments[parent[a]];
+    Index b = s.reversed ? rawNext[a] : rawPrev[a];
+    return (b != none) ? b : tailOf(order[(s.rank + numSegments - 1) % numSegments]);
+}
+
+template <typename Index>
+bool twoLevelList<Index>::precedes(int a, int b) const {
+    int rankA = segments[parent[a]].rank, rankB = segments[parent[b]].rank;
+    return rankA < rankB || (rankA == rankB && index(a) < index(b));
+}
+
+template <typename Index>
+bool twoLevelList<Index>::between(int a, int b, int c) const {
+    /**
+    * -- Parameters --
+    * int a, int b, int c   : holes (a and c are the ends of the path, included)
+    * -- Return --
+    * True if going forward from a, b is met before (or at) c
+    * */
+    if (reversed)
+        std::swap(a, c);
+    if (!precedes(c, a))
+        return !precedes(b, a) && !precedes(c, b);
+    return !precedes(b, a) || !precedes(c, b);
+}
+
+template <typename Index>
+void twoLevelList<Index>::flip(int b, int c) {
+    /**
+    * Reverse the path from b to c: with a = prev(b) and d = next(c), edges (a,b) and (c,d) become (a,c) and (b,d)
+    * -- Parameters --
+    * int b, int c          : first and last holes of the path
+    * */
+    if (b == c)
+        return;
+    // Seen without the reversed bit of the tour, the same path goes from c to b
+    if (reversed)
+        std::swap(b, c);
+    reversePath(b, c);
+    if (unbalanced)
+        rebuild();
+}
+
+template <typename Index>
+void twoLevelList<Index>::reversePath(int b, int c) {
+    /**
+    * Reverse the path from b to c (going forward, without the reversed bit of the tour).
+    * Reversing the rest of the tour and then the direction of the whole tour is the same move:
+    * whichever side spans fewer segments is reversed.
+    * */
+    if (b == c)
+        return;
+    int sb = parent[b], sc = parent[c];
+    if (sb == sc) {
+        if (index(b) <= index(c)) {
+            reverseInside(sb, b, c);
+            return;
+        }
+        // c comes before b: the rest of the tour lies inside the segment
+        int d = forward(c), a = backward(b);
+        if (d != b)
+            reverseInside(sb, d, a);
+        reversed = !reversed;
+        return;
+    }
+    int pathSegments = (segments[sc].rank - segments[sb].rank + numSegments) % numSegments + 1;
+    if (2 * pathSegments > numSegments + 2) {
+        int d = forward(c), a = backward(b);
+        if (d != b)
+            reversePath(d, a);
+        reversed = !reversed;
+        return;
+    }
+    // Make b the head and c the tail of their segments (the path may end up inside a single segment)
+    while (true) {
+        sb = parent[b];
+        sc = parent[c];
+        if (sb == sc) {
+            reversePath(b, c);
+            return;
+        }
+        if (headOf(sb) != b)
+            splitBefore(b);
+        else if (tailOf(sc) != c)
+            splitAfter(c);
+        else
+            break;
+    }
+    // Reverse the order and the direction of the whole segments from sb to sc
+    int first = segments[sb].rank;
+    int count = (segments[sc].rank - first + numSegments) % numSegments + 1;
+    for (int k=0; k < count / 2; k++)
+        std::swap(order[(first + k) % numSegments], order[(first + count - 1 - k) % numSegments]);
+    for (int k=0; k < count; k++) {
+        segment& s = segments[order[(first + k) % numSegments]];
+        s.rank = (first + k) % numSegments;
+        s.reversed = !s.reversed;
+    }
+}
+
+template <typename Index>
+void twoLevelList<Index>::reverseInside(int s, int b, int c) {
+    /**
+    * Reverse the path from b to c, both in segment s (b before c): relink its holes in the opposite order
+    * */
+    segment& seg = segments[s];
+    int lo = seg.reversed ? c : b, hi = seg.reversed ? b : c;
+    buffer.clear();
+    for (int a = lo; ; a = rawNext[a]) {
+        buffer.push_back(a);
+        if (a == hi)
+            break;
+    }
+    Index left = rawPrev[lo], right = rawNext[hi];
+    int base = seq[lo], k = static_cast<int>(buffer.size());
+    for (int i=0; i<k; i++) {
+        int a = buffer[k - 1 - i];
+        seq[a] = base + i;
+        rawPrev[a] = (i == 0) ? left : static_cast<Index>(buffer[k - i]);
+        rawNext[a] = (i == k - 1) ? right : static_cast<Index>(buffer[k - 2 - i]);
+    }
+    if (left != none)
+        rawNext[left] = static_cast<Index>(buffer[k - 1]);
+    else
+        seg.first = buffer[k - 1];
+    if (right != none)
+        rawPrev[right] = static_cast<Index>(buffer[0]);
+    else
+        seg.last = buffer[0];
+}
+
+template <typename Index>
+void twoLevelList<Index>::splitBefore(int b) {
+    /**
+    * Make b the head of a segment, moving the smaller part of its segment to a neighbouring segment
+    * */
+    int s = parent[b];
+    segment& seg = segments[s];
+    int head = std::abs(seq[b] - seq[headOf(s)]);
+    if (head == 0)
+        return;
+    buffer.clear();
+    if (2 * head <= seg.size) {
+        // Holes before b go after the tail of the previous segment
+        for (int a = headOf(s); a != b; a = forward(a))
+            buffer.push_back(a);
+        if (!seg.reversed) {
+            seg.first = b;
+            rawPrev[b] = none;
+        } else {
+            seg.last = b;
+            rawNext[b] = none;
+        }
+        seg.size -= head;
+        int previous = order[(seg.rank + numSegments - 1) % numSegments];
+        for (int a : buffer)
+            append(previous, a);
+    } else {
+        // b and the holes after it go before the head of the next segment
+        int tail = backward(b);
+        for (int a = b; ; a = forward(a)) {
+            buffer.push_back(a);
+            if (a == tailOf(s))
+                break;
+        }
+        if (!seg.reversed) {
+            seg.last = tail;
+            rawNext[tail] = none;
+        } else {
+            seg.first = tail;
+            rawPrev[tail] = none;
+        }
+        seg.size -= static_cast<int>(buffer.size());
+        int following = order[(seg.rank + 1) % numSegments];
+        for (auto it = buffer.rbegin(); it != buffer.rend(); ++it)
+            prepend(following, *it);
+    }
+}
+
+template <typename Index>
+void twoLevelList<Index>::splitAfter(int c) {
+    /**
+    * Make c the tail of a segment, moving the smaller part of its segment to a neighbouring segment
+    * */
+    int s = parent[c];
+    segment& seg = segments[s];
+    int tail = std::abs(seq[tailOf(s)] - seq[c]);
+    if (tail == 0)
+        return;
+    buffer.clear();
+    if (2 * tail <= seg.size) {
+        // Holes after c go before the head of the next segment
+        for (int a = forward(c); ; a = forward(a)) {
+            buffer.push_back(a);
+            if (a == tailOf(s))
+                break;
+        }
+        if (!seg.reversed) {
+            seg.last = c;
+            rawNext[c] = none;
+        } else {
+            seg.first = c;
+            rawPrev[c] = none;
+        }
+        seg.size -= tail;
+        int following = order[(seg.rank + 1) % numSegments];
+        for (auto it = buffer.rbegin(); it != buffer.rend(); ++it)
+            prepend(following, *it);
+    } else {
+        // c and the holes before it go after the tail of the previous segment
+        int head = forward(c);
+        for (int a = headOf(s); ; a = forward(a)) {
+            buffer.push_back(a);
+            if (a == c)
+                break;
+        }
+        if (!seg.reversed) {
+            seg.first = head;
+            rawPrev[head] = none;
+        } else {
+            seg.last = head;
+            rawNext[head] = none;
+        }
+        seg.size -= static_cast<int>(buffer.size());
+        int previous = order[(seg.rank + numSegments - 1) % numSegments];
+        for (int a : buffer)
+            append(previous, a);
+    }
+}
+
+template <typename Index>
+void twoLevelList<Index>::append(int s, int a) {
+    segment& seg = segments[s];
+    parent[a] = static_cast<Index>(s);
+    if (!seg.reversed) {
+        rawPrev[a] = static_cast<Index>(seg.last);
+        rawNext[a] = none;
+        rawNext[seg.last] = static_cast<Index>(a);
+        seq[a] = seq[seg.last] + 1;
+        seg.last = a;
+    } else {
+        rawNext[a] = static_cast<Index>(seg.first);
+        rawPrev[a] = none;
+        rawPrev[seg.first] = static_cast<Index>(a);
+        seq[a] = seq[seg.first] - 1;
+        seg.first = a;
+    }
+    if (++seg.size > TWO_LEVEL_MAX_GROWTH * groupSize)
+        unbalanced = true;
+}
+
+template <typename Index>
+void twoLevelList<Index>::prepend(int s, int a) {
+    segment& seg = segments[s];
+    parent[a] = static_cast<Index>(s);
+    if (!seg.reversed) {
+        rawNext[a] = static_cast<Index>(seg.first);
+        rawPrev[a] = none;
+        rawPrev[seg.first] = static_cast<Index>(a);
+        seq[a] = seq[seg.first] - 1;
+        seg.first = a;
+    } else {
+        rawPrev[a] = static_cast<Index>(seg.last);
+        rawNext[a] = none;
+        rawNext[seg.last] = static_cast<Index>(a);
+        seq[a] = seq[seg.last] + 1;
+        seg.last = a;
+    }
+    if (++seg.size > TWO_LEVEL_MAX_GROWTH * groupSize)
+        unbalanced = true;
+}
+
+// Instantiated for the two index widths (see twoLevelList.h)
+template class twoLevelList<uint16_t>;
+template class twoLevelList<uint32_t>;
@@ -0,0 +1,68 @@
+#ifndef TWOLEVELLIST_H
+#define TWOLEVELLIST_H
+
+/**
+ * @file twoLevelList.h/cpp
+ * @brief Tour stored as a two-level doubly-linked list: O(1) next/prev/between, O(sqrt(n)) reversals.
+ */
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+// Segments are rebuilt once one of them grows past this many times the nominal segment size
+#define TWO_LEVEL_MAX_GROWTH 3
+// Largest tour stored with 16-bit indices (the largest index value marks the end of a segment)
+#define TWO_LEVEL_MAX_SHORT 65535
+
+/*
+ * The tour is cut into about sqrt(n) segments of consecutive holes. Each segment has a reversed bit and a
+ * rank (its place in the tour); holes have a sequence number inside their segment. Reversing a path only
+ * splits at most two segments and flips the bits and order of the whole segments in between, and the
+ * whole tour has a reversed bit too, so that the shorter side of the tour is always the one reversed.
+ * Tours of at least 8 holes get at least four segments, smaller ones a single segment.
+ * Links and parents are stored as Index (uint16_t up to TWO_LEVEL_MAX_SHORT holes, uint32_t beyond): half the
+ * memory, and twice the holes per cache line, on tours that fit in 16 bits.
+ */
+template <typename Index>
+class twoLevelList {
+public:
+    void build(const std::vector<int>& tour);           // Load a tour (tour[i] = i-th hole)
+    void toVector(std::vector<int>& tour, int start) const;  // Write the tour, starting from hole "start"
+    int next(int a) const { return reversed ? backward(a) : forward(a); }
+    int prev(int a) const { return reversed ? forward(a) : backward(a); }
+    bool between(int a, int b, int c) const;            // Whether b is on the path going from a to c
+    void flip(int b, int c);                            // Reverse the path going from b to c
+    int size() const { return numHoles; }
+private:
+    static constexpr Index none = std::numeric_limits<Index>::max();   // No link (end of a segment)
+    struct segment {
+        int first, last;                    // End holes, in the (raw) order of the links
+        int size, rank;
+        bool reversed;
+    };
+    int forward(int a) const;               // Next and previous holes, ignoring the reversed bit of the tour
+    int backward(int a) const;
+    int headOf(int s) const { return segments[s].reversed ? segments[s].last : segments[s].first; }
+    int tailOf(int s) const { return segments[s].reversed ? segments[s].first : segments[s].last; }
+    int index(int a) const { return segments[parent[a]].reversed ? -seq[a] : seq[a]; }
+    bool precedes(int a, int b) const;      // Order of a and b from the head of the first segment
+    void reversePath(int b, int c);         // flip(), ignoring the reversed bit of the tour
+    void reverseInside(int s, int b, int c);
+    void splitBefore(int b);
+    void splitAfter(int c);
+    void append(int s, int a);              // Add a hole after the tail/before the head of a segment
+    void prepend(int s, int a);
+    void rebuild();
+
+    int numHoles = 0, numSegments = 0, groupSize = 0;
+    bool reversed = false, unbalanced = false;
+    std::vector<Index> rawNext, rawPrev;    // Links inside a segment (none at its ends)
+    std::vector<Index> parent;
+    std::vector<int> seq;                   // Sequence numbers (may go negative as holes are prepended)
+    std::vector<segment> segments;
+    std::vector<int> order;                 // Segments in tour order
+    std::vector<int> buffer;
+};
+
+#endif //TWOLEVELLIST_H
@@ -3,9 +3,12 @@
 #include "../Utilities/utils.h"
 #include "Ant Colony System/ACSHeuristic.h"
 #include <numeric>
+#include <algorithm>
 #include <iomanip>
 #include <sstream>
 #include <fstream>
+#include <chrono>
+#include <mutex>
 
 /**
  * @file solverManager.h/cpp
@@ -13,13 +16,14 @@
  */
 
 // --- PRIVATE ---
-long solverManager::solveIndividualCPLEX(const Data& data, int inst_num, resultValues& solutions) {
+long solverManager::solveIndividualCPLEX(const Data& data, int inst_num, resultValues& solutions, stats& statistics) {
     /**
     * Solve an individual problem with given Data with the CPLEX exact solution
     * -- Parameters --
     * const Data& Data      : number of holes and distance matrix of the problem
     * int inst_num          : number of the instance being run (if more than one)
     * double& objVal        : variable where to save the exact solution to the problem
+    * stats& statistics     : statistics of the numTests runs
     * -- Return --
     * The amount of time (ms) required to solve the instance
     * */
@@ -27,12 +31,8 @@ long solverManager::solveIndividualCPLEX(const Data& data, int inst_num, resultV
         std::cout << "    - Test # " << inst_num + 1 << std::endl;
         std::cout << "    Solving an instance with " << data.numHoles << " holes." << std::endl;
     }
-    // --- Statistics ---
-    double minObj = static_cast<double>(INT_MAX), maxObj = 0;
-    double minTime = static_cast<double>(INT_MAX), maxTime = 0;
     std::vector<double> objectives;
     std::vector<double> timings;
-    // ------------------
     // if numTests > 1, the same test is repeated and the average time is returned
     for(int i=0; i<numTests; i++) {
         DECL_ENV(env);
@@ -40,38 +40,23 @@ long solverManager::solveIndividualCPLEX(const Data& data, int inst_num, resultV
         TSPSolver tsp(env, lp, data);
         tsp.initLP();
         tsp.solveLP(informativeness);
-        auto obj = tsp.getObj();
-        auto time = tsp.getSolveTime();
-        objectives.emplace_back(obj);
-        timings.emplace_back(time);
-        if (obj > maxObj)
-            maxObj = obj;
-        if (obj < minObj)
-            minObj = obj;
-        if (time > maxTime)
-            maxTime = time;
-        if (time < minTime)
-            minTime = time;
+        objectives.emplace_back(tsp.getObj());
+        timings.emplace_back(tsp.getSolveTime());
     }
-    double meanObj, stdevObj;
-    Utils::stdev(objectives, meanObj, stdevObj);
-    solutions.optimalObj = meanObj;
-    double meanTime, stdevTime;
-    Utils::stdev(timings, meanTime, stdevTime);
-    solutions.optimalTime = meanTime;
-    CPLEXstatistics.emplace_back(
-            stats{meanTime, stdevTime, maxTime, minTime,
-                  meanObj, stdevObj, maxObj, minObj});
+    statistics = summarize(objectives, timings);
+    solutions.optimalObj = statistics.meanObj;
+    solutions.optimalTime = statistics.meanTime_ms;
     return std::ceil(solutions.optimalTime);
 }
 
-long solverManager::solveIndividualACS(const Data& data, int inst_num, resultValues& solutions){
+long solverManager::solveIndividualACS(const Data& data, int inst_num, resultValues& solutions, stats& statistics){
     /**
-    * Solve an individual problem with given Data with the ACS metaheuristic
+    * Solve an individual problem with given Data with the ACS metaheuristic, its ants spread over the workers
     * -- Parameters --
     * const Data& Data              : number of holes and distance matrix of the problem
     * int inst_num                  : number of the instance being run (if more than one)
     * const double optimalSolution  : the optimal solution to the problem (not strictly necessary; comparison-related)
+    * stats& statistics             : statistics of the numTests runs
     * -- Return --
     * The amount of time (ms) required to solve the instance
     * */
@@ -79,43 +64,101 @@ long solverManager::solveIndividualACS(const Data& data, int inst_num, resultVal
         std::cout << "    - Test # " << inst_num + 1 << std::endl;
         std::cout << "    Solving an instance with " << data.numHoles << " holes." << std::endl;
     }
-    // --- Statistics ---
-    double minObj = static_cast<double>(INT_MAX), maxObj = 0;
-    double minTime = static_cast<double>(INT_MAX), maxTime = 0;
     std::vector<double> objectives;
     std::vector<double> timings;
-    // ------------------
-    auto distances = data.timesMap;
-    ACSHeuristic ants(params, &distances, solutions.optimalObj, true);
+    ACSHeuristic ants(params, &data.timesMap, solutions.optimalObj, false);
+    ants.shareThreads(workers.get());
     for(int i=0; i<numTests; i++) {
         ants.optimize();
-        auto obj = ants.getObj();
-        auto time = ants.getTime();
-        objectives.emplace_back(obj);
-        timings.emplace_back(time);
-        if (obj > maxObj)
-            maxObj = obj;
-        if (obj < minObj)
-            minObj = obj;
-        if (time > maxTime)
-            maxTime = time;
-        if (time < minTime)
-            minTime = time;
+        objectives.emplace_back(ants.getObj());
+        timings.emplace_back(ants.getTime());
         ants.reset();
     }
-    double meanObj, stdevObj;
-    Utils::stdev(objectives, meanObj, stdevObj);
-    solutions.approxObj = meanObj;
-    double meanTime, stdevTime;
-    Utils::stdev(timings, meanTime, stdevTime);
-    solutions.approxTime = meanTime;
-    ACSstatistics.emplace_back(
-            stats{meanTime, stdevTime, maxTime, minTime,
-                  meanObj, stdevObj, maxObj, minObj});
+    statistics = summarize(objectives, timings);
+    solutions.approxObj = statistics.meanObj;
+    solutions.approxTime = statistics.meanTime_ms;
     // if numTests > 1, the same test is repeated and the average time is returned
     return std::ceil(solutions.approxTime);
 }
 
+void solverManager::solveBatchACS() {
+    /**
+    * Solve all instances with the ACS metaheuristic, numTests times each. The runs on boards smaller than
+    * BATCH_INTRA_MIN_HOLES are independent tasks, each on a single core: idle workers take the next one, largest
+    * boards first (the shortest runs fill the gaps at the end). Larger boards are then solved one at a time, their
+    * ants spread over the same workers. No more threads than cores are ever running, and with a fixed seed the
+    * results do not depend on the schedule (test t of an instance always is run number t, see ACSHeuristic::reset).
+    * */
+    struct acsRun { int interval, problem; unsigned test; };
+    std::vector<acsRun> batch;
+    for (int i = 0; i < num_intervals; i++) {
+        if ((*num_holes)[i] >= BATCH_INTRA_MIN_HOLES)
+            continue;
+        for (int j = 0; j < n_problems_per_size; j++)
+            for (unsigned t = 0; t < numTests; t++)
+                batch.push_back(acsRun{i, j, t});
+    }
+    std::stable_sort(batch.begin(), batch.end(), [this](const acsRun& a, const acsRun& b) {
+        return (*num_holes)[a.interval] > (*num_holes)[b.interval];
+    });
+    if (informativeness != SILENT)
+        std::cout << "    Batch of " << batch.size() << " runs on small boards, over "
+                  << workers->size() << " thread(s)." << std::endl;
+    // Objective value and time of every run, at (interval, problem, test)
+    auto slot = [this](int i, int j, unsigned t) {
+        return (static_cast<std::size_t>(i) * n_problems_per_size + j) * numTests + t;
+    };
+    std::vector<double> objectives(static_cast<std::size_t>(num_intervals) * n_problems_per_size * numTests);
+    std::vector<double> timings(objectives.size());
+    workers->parallelFor(static_cast<int>(batch.size()), 1, [&](int first, int last, unsigned) {
+        for (int r = first; r < last; r++) {
+            const acsRun& run = batch[r];
+            ACSHeuristic ants(params, &(*times)[run.interval][run.problem],
+                              (*results)[run.interval][run.problem].optimalObj, false);
+            if (run.test > 0)
+                ants.reset(run.test);
+            ants.optimize();
+            objectives[slot(run.interval, run.problem, run.test)] = ants.getObj();
+            timings[slot(run.interval, run.problem, run.test)] = ants.getTime();
+        }
+    });
+    for (int i = 0; i < num_intervals; i++) {
+        for (int j = 0; j < n_problems_per_size; j++) {
+            resultValues& solutions = (*results)[i][j];
+            if ((*num_holes)[i] >= BATCH_INTRA_MIN_HOLES) {
+                solveIndividualACS(Data((*num_holes)[i], (*times)[i][j]), j, solutions, ACSstatistics[i][j]);
+                continue;
+            }
+            std::size_t from = slot(i, j, 0), to = slot(i, j, numTests);
+            ACSstatistics[i][j] = summarize(std::vector<double>(objectives.begin() + from, objectives.begin() + to),
+                                            std::vector<double>(timings.begin() + from, timings.begin() + to));
+            solutions.approxObj = ACSstatistics[i][j].meanObj;
+            solutions.approxTime = ACSstatistics[i][j].meanTime_ms;
+        }
+    }
+}
+
+stats solverManager::summarize(const std::vector<double>& objectives, const std::vector<double>& timings) {
+    /**
+    * -- Parameters --
+    * const std::vector<double>& objectives : objective values of the runs on an instance
+    * const std::vector<double>& timings    : their times (ms)
+    * -- Return --
+    * Mean, standard deviation and extremes of both
+    * */
+    stats result{};
+    result.minObj = result.minTime = static_cast<double>(INT_MAX);
+    for (std::size_t i = 0; i < objectives.size(); i++) {
+        result.maxObj = std::max(result.maxObj, objectives[i]);
+        result.minObj = std::min(result.minObj, objectives[i]);
+        result.maxTime = std::max(result.maxTime, timings[i]);
+        result.minTime = std::min(result.minTime, timings[i]);
+    }
+    Utils::stdev(objectives, result.meanObj, result.stdev_obj);
+    Utils::stdev(timings, result.meanTime_ms, result.stdev_ms);
+    return result;
+}
+
 // --- PUBLIC ---
 void solverManager::generate(int maxHoles, boardType type, int dist_type){
     /**
@@ -143,33 +186,56 @@ void solverManager::generate(int maxHoles, boardType type, int dist_type){
 
         // There will be num_intervals different number of holes
         // (e.g. 10 instances that differ in how many holes the board has)
-        {
-            // For each instance with different number of holes
-            for (int i = 0; i < num_intervals; i++) {
-                // Evaluate different configuration for the same number of holes
-                // (e.g. 5 instances that have same number of holes but different times)
-                // For each instance with same number of holes
-                for (int j = 0; j < n_problems_per_size; j++) {
-
-                    if (informativeness!=SILENT)
-                        std::cout << "Asking for a board with " << (*num_holes)[i] << " holes..." << std::endl;
-                    switch(type){
-                        case RandomAsym:
-                            boardGenerator::generateAsymBoard((*times)[i][j], (*num_holes)[i], MAX_DIAG);
-                            break;
-                        case RandomSym:
-                            boardGenerator::generateSymBoard((*times)[i][j], (*num_holes)[i], MAX_DIAG);
-                            break;
-                        case CointossGrid:
-                            boardGenerator::generateCoinTossGridBoard((*times)[i][j], (*num_holes)[i], dist_type, informativeness);
-                            break;
-                        case Polygons:
-                            boardGenerator::generateGeometricBoard((*times)[i][j], (*num_holes)[i], dist_type);
-                            break;
-                    }
-                }
+        // Evaluate different configuration for the same number of holes
+        // (e.g. 5 instances that have same number of holes but different times)
+        // Board (i, j) is drawn from its own seed, derived from the master seed: the boards do not depend on which
+        // thread generates them, nor on how many threads there are
+        uint64_t master = (params.seed != 0) ? params.seed
+                          : static_cast<uint64_t>(std::chrono::high_resolution_clock::now().time_since_epoch().count());
+        // Files are named after the size only: the last board of each size is saved, whatever the thread timing
+        std::mutex printMutex;
+        auto board = [&](int i, int j, int verbosity, threadPool* pool) {
+            uint64_t seed = rngStream(master, static_cast<uint64_t>(i) * n_problems_per_size + j).next();
+            bool save = (j == n_problems_per_size - 1);
+            if (informativeness!=SILENT) {
+                std::lock_guard<std::mutex> lock(printMutex);
+                std::cout << "Asking for a board with " << (*num_holes)[i] << " holes..." << std::endl;
+            }
+            switch(type){
+                case RandomAsym:
+                    boardGenerator::generateAsymBoard((*times)[i][j], (*num_holes)[i], MAX_DIAG, seed, pool);
+                    break;
+                case RandomSym:
+                    boardGenerator::generateSymBoard((*times)[i][j], (*num_holes)[i], MAX_DIAG, seed, pool);
+                    break;
+                case CointossGrid:
+                    boardGenerator::generateCoinTossGridBoard((*times)[i][j], (*num_holes)[i], dist_type, verbosity,
+                                                              seed, pool, save);
+                    break;
+                case Polygons:
+                    boardGenerator::generateGeometricBoard((*times)[i][j], (*num_holes)[i], dist_type, seed, pool,
+                                                           save);
+                    break;
+            }
+        };
+        std::vector<std::pair<int, int>> small;
+        for (int i = 0; i < num_intervals; i++) {
+            for (int j = 0; j < n_problems_per_size; j++) {
+                if ((*num_holes)[i] < GENERATION_INTRA_MIN_HOLES)
+                    small.emplace_back(i, j);
             }
-
+        }
+        // Small boards: one per core (only announced: messages of concurrent boards would be mixed up)
+        workers->parallelFor(static_cast<int>(small.size()), 1, [&](int first, int last, unsigned) {
+            for (int b = first; b < last; b++)
+                board(small[b].first, small[b].second, SILENT, nullptr);
+        });
+        // Large boards: one at a time, all cores on their rows
+        for (int i = 0; i < num_intervals; i++) {
+            if ((*num_holes)[i] < GENERATION_INTRA_MIN_HOLES)
+                continue;
+            for (int j = 0; j < n_problems_per_size; j++)
+                board(i, j, informativeness, workers.get());
         }
     } catch(std::exception& e)
     {
@@ -191,7 +257,8 @@ void solverManager::solveAllCPLEX() {
         // Iterate different tests for same holes number
         double avg_time = 0;
         for (int j = 0; j < n_problems_per_size; j++) {
-            avg_time += solveIndividualCPLEX(Data((*num_holes)[i], (*times)[i][j]), j, (*results)[i][j]);
+            avg_time += solveIndividualCPLEX(Data((*num_holes)[i], (*times)[i][j]), j, (*results)[i][j],
+                                             CPLEXstatistics[i][j]);
         }
         if (informativeness != SILENT)
             std::cout << "    (!) Avg time (rounded up): " << std::ceil(avg_time/n_problems_per_size) << "ms ("
@@ -208,6 +275,7 @@ void solverManager::solveAllACS(){
     // Solve each instance
     std::cout << "---------------------------------------" << std::endl;
     std::cout << "    ACS: Initiating solve sequence..." << std::endl;
+    solveBatchACS();
     // Iterate number of holes
     for (int i = 0; i < num_intervals; i++) {
         if (informativeness != SILENT)
@@ -215,7 +283,7 @@ void solverManager::solveAllACS(){
         // Iterate different tests for same holes number
         double avg_time = 0;
         for (int j = 0; j < n_problems_per_size; j++)
-            avg_time += solveIndividualACS(Data((*num_holes)[i], (*times)[i][j]), j, (*results)[i][j]);
+            avg_time += std::ceil((*results)[i][j].approxTime);
         if (informativeness != SILENT)
             std::cout << "    (!) Avg time (rounded up): " << std::ceil(avg_time/n_problems_per_size) << "ms ("
                   << std::ceil(avg_time/n_problems_per_size)/1000.0 << " second(s))."  << std::endl;
@@ -231,14 +299,16 @@ void solverManager::solveAllWithStats(bool save) {
     * */
     std::cout << "---------------------------------------" << std::endl;
     std::cout << "    Initiating solve sequence..." << std::endl;
-    // Iterate number of holes
+    // CPLEX first (one instance at a time): optimal values are the targets of the ACS runs
     for (int i = 0; i < num_intervals; i++) {
         // Iterate different tests for same holes number
         std::cout << "Solving instances with " << (*num_holes)[i] << " holes..." << std::endl;
-        for (int j = 0; j < n_problems_per_size; j++) {
-            solveIndividualCPLEX(Data((*num_holes)[i], (*times)[i][j]), j, (*results)[i][j]);
-            solveIndividualACS(Data((*num_holes)[i], (*times)[i][j]), j, (*results)[i][j]);
-        }
+        for (int j = 0; j < n_problems_per_size; j++)
+            solveIndividualCPLEX(Data((*num_holes)[i], (*times)[i][j]), j, (*results)[i][j], CPLEXstatistics[i][j]);
+    }
+    // Then all the ACS runs at once
+    solveBatchACS();
+    for (int i = 0; i < num_intervals; i++) {
         // Recap CPLEX and ACS stats
         std::cout << "    Collecting statistics on " << n_problems_per_size
             << " instances with " << (*num_holes)[i] << " holes ("<< numTests <<" tests for each instance)..." << std::endl;
@@ -255,19 +325,19 @@ void solverManager::solveAllWithStats(bool save) {
          * */
         for(int idx=0; idx<n_problems_per_size; idx++){
             // --- CPLEX ---
-            timingsCPLEX.emplace_back(CPLEXstatistics[idx].meanTime_ms);
-            stdevTimeCPLEX.emplace_back(CPLEXstatistics[idx].stdev_ms);
-            if (CPLEXstatistics[idx].maxTime > maxTimeCPLEX)    { maxTimeCPLEX = CPLEXstatistics[idx].maxTime; }
-            if (CPLEXstatistics[idx].minTime < minTimeCPLEX)    { minTimeCPLEX = CPLEXstatistics[idx].minTime; }
+            timingsCPLEX.emplace_back(CPLEXstatistics[i][idx].meanTime_ms);
+            stdevTimeCPLEX.emplace_back(CPLEXstatistics[i][idx].stdev_ms);
+            if (CPLEXstatistics[i][idx].maxTime > maxTimeCPLEX)    { maxTimeCPLEX = CPLEXstatistics[i][idx].maxTime; }
+            if (CPLEXstatistics[i][idx].minTime < minTimeCPLEX)    { minTimeCPLEX = CPLEXstatistics[i][idx].minTime; }
             // --- ACS ---
-            timingsACS.emplace_back(ACSstatistics[idx].meanTime_ms);
-            stdevTimeACS.emplace_back(ACSstatistics[idx].stdev_ms);
-            stdevObjACS.emplace_back(ACSstatistics[idx].stdev_obj);
-            if (ACSstatistics[idx].maxTime > maxTimeACS)    { maxTimeACS = ACSstatistics[idx].maxTime; }
-            if (ACSstatistics[idx].minTime < minTimeACS)    { minTimeACS = ACSstatistics[idx].minTime; }
-            if (ACSstatistics[idx].maxObj > maxObj)         { maxObj = ACSstatistics[idx].maxObj; }
-            if (ACSstatistics[idx].minObj < minObj)         { minObj = ACSstatistics[idx].minObj; }
-            double error = Utils::percentDifference(ACSstatistics[idx].meanObj, CPLEXstatistics[idx].meanObj);
+            timingsACS.emplace_back(ACSstatistics[i][idx].meanTime_ms);
+            stdevTimeACS.emplace_back(ACSstatistics[i][idx].stdev_ms);
+            stdevObjACS.emplace_back(ACSstatistics[i][idx].stdev_obj);
+            if (ACSstatistics[i][idx].maxTime > maxTimeACS)    { maxTimeACS = ACSstatistics[i][idx].maxTime; }
+            if (ACSstatistics[i][idx].minTime < minTimeACS)    { minTimeACS = ACSstatistics[i][idx].minTime; }
+            if (ACSstatistics[i][idx].maxObj > maxObj)         { maxObj = ACSstatistics[i][idx].maxObj; }
+            if (ACSstatistics[i][idx].minObj < minObj)         { minObj = ACSstatistics[i][idx].minObj; }
+            double error = Utils::percentDifference(ACSstatistics[i][idx].meanObj, CPLEXstatistics[i][idx].meanObj);
             if (error > maxError) { maxError = error; }
             if (error < minError) { minError = error; }
             errors.emplace_back(error);
@@ -284,9 +354,6 @@ void solverManager::solveAllWithStats(bool save) {
                                               meanTimeACS_ms, stdevMeanACS_ms, maxTimeACS, minTimeACS,
                                               (std::accumulate(stdevObjACS.begin(), stdevObjACS.end(),0.0))/num_intervals,
                                               meanError, stdevError, maxError, minError});
-        // clear
-        CPLEXstatistics.clear();
-        ACSstatistics.clear();
     }
     printStatistics();
     if (save)
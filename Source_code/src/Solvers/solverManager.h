@@ -8,6 +8,15 @@
 
 #include "cpxmacro.h"
 #include "TSPSolver.h"
+#include "../Utilities/threadPool.h"
+#include <memory>
+
+// Batch of ACS runs: boards with at least this many holes are solved one at a time, their ants sharing the cores
+// (intra-instance). Smaller ones are too cheap to split: each run takes a single core (inter-instance)
+#define BATCH_INTRA_MIN_HOLES 500
+// Generation: boards with at least this many holes are generated one at a time, blocks of rows of their distance
+// matrix shared by the cores. Smaller boards are generated concurrently, each on a single core
+#define GENERATION_INTRA_MIN_HOLES 2000
 
 // Types of board
 enum boardType{ RandomAsym, RandomSym, CointossGrid, Polygons };
@@ -37,8 +46,10 @@ struct plotStats{
 
 class solverManager {
 private:
-    long solveIndividualCPLEX(const Data& data, int inst_num, resultValues& solutions);
-    long solveIndividualACS(const Data& data, int inst_num, resultValues& solutions);
+    long solveIndividualCPLEX(const Data& data, int inst_num, resultValues& solutions, stats& statistics);
+    long solveIndividualACS(const Data& data, int inst_num, resultValues& solutions, stats& statistics);
+    void solveBatchACS();                                   // ACS on every instance and test, on the shared workers
+    static stats summarize(const std::vector<double>& objectives, const std::vector<double>& timings);
     // --- Params ---
     std::vector<std::vector<resultValues>>* results;        // Structure containing objective/time values found in all instances
     ACSparameters params;                                   // Parameters for the ACS heuristic
@@ -48,17 +59,23 @@ private:
     int n_problems_per_size;                                // How many problems are generated for each size (e.g. same # holes)
     int num_intervals;                                      // How many intervals are generated between the 0 and the max number of holes
     unsigned numTests;                                      // How many time to run on the SAME instance
-    std::vector<stats> CPLEXstatistics;                     // Useful statistics
-    std::vector<stats> ACSstatistics;
+    std::vector<std::vector<stats>> CPLEXstatistics;        // Useful statistics (for each instance)
+    std::vector<std::vector<stats>> ACSstatistics;
     std::vector<plotStats> plotStatistics;
+    std::unique_ptr<threadPool> workers;                    // One thread per core, shared by all the batches
     void init(){
         results->resize(num_intervals);
         times->resize(num_intervals);
         num_holes->reserve(num_intervals);
+        CPLEXstatistics.resize(num_intervals);
+        ACSstatistics.resize(num_intervals);
         for (int i=0; i<num_intervals; i++) {
             (*results)[i].resize(n_problems_per_size);
             (*times)[i].resize(n_problems_per_size);
+            CPLEXstatistics[i].resize(n_problems_per_size);
+            ACSstatistics[i].resize(n_problems_per_size);
         }
+        workers = std::make_unique<threadPool>();
     }
 public:
     solverManager(std::vector<std::vector<resultValues>>* _objValues, ACSparameters _params, std::vector<int> * _num_holes,
@@ -0,0 +1,281 @@
+#include "binaryInstance.h"
+#include "distanceProvider.h"
+#include "utils.h"
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+
+/**
+ * @file binaryInstance.h/cpp
+ * @brief Binary instance files: a header and the distance matrix as the solvers store it, mapped in memory.
+ */
+
+// Files are mapped where mmap is available, read at once elsewhere (same matrix, copied)
+#if defined(__unix__) || defined(__APPLE__)
+#define BINARY_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define BINARY_MMAP 0
+#endif
+
+template <typename T>
+static void writeRows(std::ofstream& out, const doubleMap& times, std::size_t stride) {
+    /* Rows of the matrix as T values, each followed by zeros up to stride values */
+    std::vector<T> row(stride, T(0));
+    for (std::size_t i = 0; i < times.size(); i++) {
+        for (std::size_t j = 0; j < times.size(); j++)
+            row[j] = static_cast<T>(times[i][j]);
+        out.write(reinterpret_cast<const char*>(row.data()), static_cast<std::streamsize>(stride * sizeof(T)));
+    }
+}
+
+static bool fitsIn(uint64_t offset, uint64_t count, std::size_t size, std::size_t bytes) {
+    /* Whether count values of size bytes, from offset, end within the first bytes of the file */
+    return offset <= bytes && (size == 0 || count <= (bytes - offset) / size);
+}
+
+long binaryInstance::load(const std::string& filename) {
+    /**
+    * Load an instance. Binary files are mapped in memory (float64 matrices are used in place), other files are
+    * parsed as .dat files (slow on large instances: see convertDAT)
+    * -- Parameters --
+    * const std::string& filename   : name of the file to load
+    * -- Return --
+    * Number of holes, -1 if the file could not be loaded
+    * */
+    unmap();
+    coordMap.clear();
+    isSymmetric = false;
+    distMode = BINARY_METRIC_UNKNOWN;
+    try {
+        if (!isBinary(filename)) {
+            if (!std::ifstream(filename))
+                throw std::runtime_error(std::string(__FILE__) + ": " + "Unable to open " + filename);
+            long numHoles = Utils::loadFromDAT(times, filename);
+            isSymmetric = distanceProvider(&times).symmetric();
+            return numHoles;
+        }
+#if BINARY_MMAP
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw std::runtime_error(std::string(__FILE__) + ": " + "Unable to open " + filename);
+        struct stat info{};
+        if (::fstat(fd, &info) != 0) {
+            ::close(fd);
+            throw std::runtime_error(std::string(__FILE__) + ": " + "Unable to read the size of " + filename);
+        }
+        // Private (copy-on-write) mapping: the matrix is writable like any doubleMap, the file never changes
+        void* address = ::mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ | PROT_WRITE,
+                               MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (address == MAP_FAILED)
+            throw std::runtime_error(std::string(__FILE__) + ": " + "Unable to map " + filename);
+        mapping = address;
+        mappedBytes = static_cast<std::size_t>(info.st_size);
+        readSections(static_cast<const char*>(mapping), mappedBytes);
+#else
+        std::ifstream in(filename, std::ios::binary);
+        std::vector<char> file((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        readSections(file.data(), file.size());
+#endif
+        return static_cast<long>(times.size());
+    } catch(std::exception& e) {
+        std::cout << ">>>EXCEPTION: " << e.what() << std::endl;
+        unmap();
+        coordMap.clear();
+        return -1;
+    }
+}
+
+void binaryInstance::readSections(const char* file, std::size_t bytes) {
+    /**
+    * Check the header, then take the matrix and the coordinates
+    * -- Parameters --
+    * const char* file      : contents of the file (mapped, or read)
+    * std::size_t bytes     : size of the file
+    * */
+    binaryHeader header{};
+    if (bytes < sizeof(header))
+        throw std::runtime_error(std::string(__FILE__) + ": " + "Truncated binary instance (no header).");
+    std::memcpy(&header, file, sizeof(header));
+    if (std::memcmp(header.magic, BINARY_MAGIC, sizeof(header.magic)) != 0 || header.version != BINARY_VERSION)
+        throw std::runtime_error(std::string(__FILE__) + ": " + "Unsupported binary instance version.");
+    if (header.byteOrder != BINARY_BYTE_ORDER)
+        throw std::runtime_error(std::string(__FILE__) + ": " + "Binary instance written with another byte order.");
+    if (header.dtype != BINARY_FLOAT64 && header.dtype != BINARY_FLOAT32)
+        throw std::runtime_error(std::string(__FILE__) + ": " + "Unrecognized type of distances.");
+    std::size_t numHoles = header.numHoles, stride = header.stride;
+    std::size_t valueSize = (header.dtype == BINARY_FLOAT64) ? sizeof(double) : sizeof(float);
+    // Sizes are checked by division: a corrupted header must not overflow a product past the size of the file
+    if (stride < numHoles || stride > bytes / valueSize || header.matrixOffset % MATRIX_ALIGNMENT != 0
+        || !fitsIn(header.matrixOffset, numHoles, stride * valueSize, bytes)
+        || (header.coordOffset != 0 && !fitsIn(header.coordOffset, numHoles, 2 * sizeof(double), bytes)))
+        throw std::runtime_error(std::string(__FILE__) + ": " + "Truncated or corrupted binary instance.");
+    isSymmetric = header.symmetric != 0;
+    distMode = header.metric;
+    // --- Matrix ---
+    if (header.dtype == BINARY_FLOAT64 && mapping != nullptr && stride == doubleMap::strideFor(numHoles)) {
+        // Rows already are those of a doubleMap (the mapping starts on a page boundary): no copy
+        auto rows = reinterpret_cast<double*>(static_cast<char*>(mapping) + header.matrixOffset);
+        times = doubleMap::view(rows, numHoles, numHoles, stride);
+    } else if (header.dtype == BINARY_FLOAT64) {
+        copyRows<double>(file + header.matrixOffset, numHoles, stride);
+    } else {
+        copyRows<float>(file + header.matrixOffset, numHoles, stride);
+    }
+    // --- Coordinates ---
+    if (header.coordOffset != 0) {
+        const char* xs = file + header.coordOffset;
+        const char* ys = xs + numHoles * sizeof(double);
+        for (std::size_t i = 0; i < numHoles; i++) {
+            double x, y;
+            std::memcpy(&x, xs + i * sizeof(double), sizeof(double));
+            std::memcpy(&y, ys + i * sizeof(double), sizeof(double));
+            coordMap.emplace_back(x, y);
+        }
+    }
+}
+
+template <typename T>
+void binaryInstance::copyRows(const char* rows, std::size_t numHoles, std::size_t stride) {
+    /**
+    * Copy (and convert) the stored rows into a matrix of doubles
+    * -- Parameters --
+    * const char* rows      : first stored row
+    * std::size_t numHoles  : number of rows, and of values in each
+    * std::size_t stride    : stored values per row (padding included)
+    * */
+    times.resize(numHoles, numHoles);
+    std::vector<T> row(numHoles);
+    for (std::size_t i = 0; i < numHoles; i++) {
+        std::memcpy(row.data(), rows + i * stride * sizeof(T), numHoles * sizeof(T));
+        for (std::size_t j = 0; j < numHoles; j++)
+            times[i][j] = static_cast<double>(row[j]);
+    }
+}
+
+void binaryInstance::unmap() {
+    /* Drop the matrix (it may view the mapping), then the mapping */
+    times.clear();
+#if BINARY_MMAP
+    if (mapping != nullptr)
+        ::munmap(mapping, mappedBytes);
+#endif
+    mapping = nullptr;
+    mappedBytes = 0;
+}
+
+bool binaryInstance::isBinary(const std::string& filename) {
+    /**
+    * -- Parameters --
+    * const std::string& filename   : name of the file
+    * -- Return --
+    * Whether the file starts as a binary instance
+    * */
+    char magic[sizeof(binaryHeader::magic)] = {};
+    std::ifstream in(filename, std::ios::binary);
+    in.read(magic, sizeof(magic));
+    return in && std::memcmp(magic, BINARY_MAGIC, sizeof(magic)) == 0;
+}
+
+bool binaryInstance::save(const std::string& filename, const doubleMap& times, int metric,
+                          const std::deque<std::pair<double, double>>* coordMap, int dtype) {
+    /**
+    * Save an instance as a binary file
+    * -- Parameters --
+    * const std::string& filename                                   : name of the file to write
+    * const doubleMap& times                                        : distance matrix
+    * int metric                                                    : MANHATTAN, EUCLIDEAN or BINARY_METRIC_UNKNOWN
+    * const std::deque<std::pair<double, double>>* coordMap         : coordinates of the holes (nullptr: none)
+    * int dtype                                                     : BINARY_FLOAT64, or BINARY_FLOAT32 (rounded)
+    * -- Return --
+    * Whether the file was written
+    * */
+    try {
+        if (dtype != BINARY_FLOAT64 && dtype != BINARY_FLOAT32)
+            throw std::runtime_error(std::string(__FILE__) + ": " + "Unrecognized type of distances.");
+        if (coordMap != nullptr && coordMap->size() != times.size())
+            throw std::runtime_error(std::string(__FILE__) + ": " + "One pair of coordinates per hole is needed.");
+        std::size_t numHoles = times.size();
+        binaryHeader header{};
+        std::memcpy(header.magic, BINARY_MAGIC, sizeof(header.magic));
+        header.version = BINARY_VERSION;
+        header.byteOrder = BINARY_BYTE_ORDER;
+        header.numHoles = numHoles;
+        // Rows are padded as in flatMatrix: every row of the matrix, and the coordinates, start on a cache line
+        header.stride = (dtype == BINARY_FLOAT64) ? doubleMap::strideFor(numHoles)
+                                                  : flatMatrix<float>::strideFor(numHoles);
+        header.matrixOffset = sizeof(binaryHeader);
+        std::size_t valueSize = (dtype == BINARY_FLOAT64) ? sizeof(double) : sizeof(float);
+        std::size_t matrixBytes = numHoles * header.stride * valueSize;
+        header.coordOffset = (coordMap != nullptr) ? header.matrixOffset + matrixBytes : 0;
+        header.metric = metric;
+        header.dtype = static_cast<uint32_t>(dtype);
+        header.symmetric = distanceProvider(&times).symmetric() ? 1 : 0;
+
+        std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+        if (!out)
+            throw std::runtime_error(std::string(__FILE__) + ": " + "Unable to create " + filename);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        if (dtype == BINARY_FLOAT64)
+            writeRows<double>(out, times, header.stride);
+        else
+            writeRows<float>(out, times, header.stride);
+        if (coordMap != nullptr) {
+            for (auto& c : *coordMap)
+                out.write(reinterpret_cast<const char*>(&c.first), sizeof(double));
+            for (auto& c : *coordMap)
+                out.write(reinterpret_cast<const char*>(&c.second), sizeof(double));
+        }
+        if (!out)
+            throw std::runtime_error(std::string(__FILE__) + ": " + "Unable to write " + filename);
+        return true;
+    } catch(std::exception& e) {
+        std::cout << ">>>EXCEPTION: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+bool binaryInstance::convertDAT(const std::string& datFile, const std::string& binFile) {
+    /**
+    * Convert a .dat file (number of holes, then the whole matrix as text) to a binary file (float64, no metric
+    * nor coordinates: a .dat file has neither)
+    * -- Parameters --
+    * const std::string& datFile    : name of the file to convert
+    * const std::string& binFile    : name of the binary file to write
+    * -- Return --
+    * Whether the file was converted
+    * */
+    doubleMap times;
+    long numHoles;
+    try {
+        if (!std::ifstream(datFile))
+            throw std::runtime_error(std::string(__FILE__) + ": " + "Unable to open " + datFile);
+        numHoles = Utils::loadFromDAT(times, datFile);
+    } catch(std::exception& e) {
+        std::cout << ">>>EXCEPTION: " << e.what() << std::endl;
+        return false;
+    }
+    if (!save(binFile, times))
+        return false;
+    std::cout << "    Converted " << datFile << " (" << numHoles << " holes) to " << binFile << std::endl;
+    return true;
+}
+
+std::string binaryInstance::binaryName(const std::string& datFile) {
+    /**
+    * -- Parameters --
+    * const std::string& datFile    : name of a .dat file
+    * -- Return --
+    * The same name, with BINARY_EXTENSION in place of .dat (appended if there is no .dat extension)
+    * */
+    const std::string dat = ".dat";
+    if (datFile.size() >= dat.size() && datFile.compare(datFile.size() - dat.size(), dat.size(), dat) == 0)
+        return datFile.substr(0, datFile.size() - dat.size()) + BINARY_EXTENSION;
+    return datFile + BINARY_EXTENSION;
+}
@@ -0,0 +1,87 @@
+#ifndef BINARYINSTANCE_H
+#define BINARYINSTANCE_H
+
+/**
+ * @file binaryInstance.h/cpp
+ * @brief Binary instance files: a header and the distance matrix as the solvers store it, mapped in memory.
+ */
+
+#include "typesAndDefs.h"
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <utility>
+
+// File extension and first bytes of a binary instance
+#define BINARY_EXTENSION ".bin"
+#define BINARY_MAGIC "ACOTSPBI"
+#define BINARY_VERSION 1
+// Written as is: any other value read back means the file comes from a machine with another byte order
+#define BINARY_BYTE_ORDER 0x01020304u
+// Type of the stored distances. Doubles are used in place, floats (half the file) are converted when loaded
+#define BINARY_FLOAT64 0
+#define BINARY_FLOAT32 1
+// Metric of the distances when unknown (e.g. converted from a .dat file), otherwise MANHATTAN or EUCLIDEAN
+#define BINARY_METRIC_UNKNOWN -1
+
+/*
+ * Layout (native byte order, each section starts on MATRIX_ALIGNMENT bytes):
+ *     header (64 bytes) | numHoles rows of stride values, zero padded | x coordinates | y coordinates
+ * Rows are laid out as in doubleMap: once mapped, a float64 matrix is the distance matrix of the solvers, without
+ * parsing or copying. Pages are read from disk when first touched, and mapped copy-on-write (the file never changes).
+ */
+struct binaryHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint64_t numHoles;
+    uint64_t stride;            // Values per row
+    uint64_t matrixOffset;      // Byte offset of the first row
+    uint64_t coordOffset;       // Byte offset of the x coordinates, y follow (0: no coordinates)
+    int32_t metric;
+    uint32_t dtype;
+    uint32_t symmetric;         // 1 if d(a,b) == d(b,a) for every pair
+    uint32_t reserved;
+};
+static_assert(sizeof(binaryHeader) == 64, "binaryHeader must take 64 bytes");
+
+class binaryInstance {
+public:
+    binaryInstance() = default;
+    ~binaryInstance() { unmap(); }
+    binaryInstance(const binaryInstance&) = delete;
+    binaryInstance& operator=(const binaryInstance&) = delete;
+
+    // Map a binary file (a .dat file is parsed instead). Number of holes, -1 on error
+    long load(const std::string& filename);
+    // Distance matrix, valid as long as this object (and until the next load)
+    const doubleMap& matrix() const { return times; }
+    int size() const { return static_cast<int>(times.size()); }
+    bool symmetric() const { return isSymmetric; }
+    int metric() const { return distMode; }
+    bool mapped() const { return !times.owned(); }
+    // Coordinates of the holes (empty if the file has none)
+    const std::deque<std::pair<double, double>>& coordinates() const { return coordMap; }
+
+    static bool isBinary(const std::string& filename);
+    static bool save(const std::string& filename, const doubleMap& times, int metric = BINARY_METRIC_UNKNOWN,
+                     const std::deque<std::pair<double, double>>* coordMap = nullptr, int dtype = BINARY_FLOAT64);
+    // Converter: .dat file to binary file
+    static bool convertDAT(const std::string& datFile, const std::string& binFile);
+    // Name of the binary file of a .dat file (same path, BINARY_EXTENSION)
+    static std::string binaryName(const std::string& datFile);
+private:
+    void unmap();
+    void readSections(const char* file, std::size_t bytes);
+    template <typename T>
+    void copyRows(const char* rows, std::size_t numHoles, std::size_t stride);
+
+    doubleMap times;
+    std::deque<std::pair<double, double>> coordMap;
+    bool isSymmetric = false;
+    int distMode = BINARY_METRIC_UNKNOWN;
+    void* mapping = nullptr;                // Mapped file (nullptr: none)
+    std::size_t mappedBytes = 0;
+};
+
+#endif //BINARYINSTANCE_H
@@ -0,0 +1,68 @@
+#include "distanceProvider.h"
+#include <stdexcept>
+#include <string>
+
+/**
+ * @file distanceProvider.h/cpp
+ * @brief Distances between holes, read from a matrix or computed on demand from the coordinates.
+ */
+
+distanceProvider::distanceProvider(const doubleMap* _matrix) :
+        matrix(_matrix), numHoles(static_cast<int>(_matrix->size())) {}
+
+distanceProvider::distanceProvider(const std::deque<std::pair<double, double>>& coordMap, int _distMode) :
+        numHoles(static_cast<int>(coordMap.size())), distMode(_distMode)
+{
+    /**
+    * Keep the coordinates only: distances are computed when asked for
+    * -- Parameters --
+    * const std::deque<std::pair<double, double>>& coordMap : coordinates of the holes
+    * int _distMode                                         : MANHATTAN or EUCLIDEAN
+    * */
+    try {
+        if (distMode != MANHATTAN && distMode != EUCLIDEAN)
+            throw std::runtime_error(std::string(__FILE__) + ": " + "Unrecognized distance identifier.");
+    } catch(std::exception& e) {
+        std::cout << ">>>EXCEPTION: " << e.what() << " (using euclidean distances)" << std::endl;
+        distMode = EUCLIDEAN;
+    }
+    xs.resize(numHoles);
+    ys.resize(numHoles);
+    for (int i=0; i<numHoles; i++) {
+        xs[i] = coordMap[i].first;
+        ys[i] = coordMap[i].second;
+    }
+}
+
+bool distanceProvider::symmetric() const {
+    /**
+    * -- Return --
+    * True if d(a,b) == d(b,a) for every pair (always true for distances computed from coordinates)
+    * */
+    if (onDemand())
+        return true;
+    for (int i=0; i<numHoles; i++)
+        for (int j=i+1; j<numHoles; j++)
+            if ((*matrix)[i][j] != (*matrix)[j][i])
+                return false;
+    return true;
+}
+
+void distanceProvider::row(int a, double* out) const {
+    /**
+    * Distances from a hole to all the others (one metric test per row, rather than per pair)
+    * -- Parameters --
+    * int a         : hole
+    * double* out   : numHoles values, out[b] = d(a, b)
+    * */
+    if (!onDemand()) {
+        for (int b=0; b<numHoles; b++)
+            out[b] = (*matrix)[a][b];
+    } else if (distMode == MANHATTAN) {
+        for (int b=0; b<numHoles; b++)
+            out[b] = metric<MANHATTAN>(xs[a], ys[a], xs[b], ys[b]);
+    } else {
+        for (int b=0; b<numHoles; b++)
+            out[b] = metric<EUCLIDEAN>(xs[a], ys[a], xs[b], ys[b]);
+    }
+}
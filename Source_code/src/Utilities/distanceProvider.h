@@ -0,0 +1,57 @@
+#ifndef DISTANCEPROVIDER_H
+#define DISTANCEPROVIDER_H
+
+/**
+ * @file distanceProvider.h/cpp
+ * @brief Distances between holes, read from a matrix or computed on demand from the coordinates.
+ */
+
+#include "typesAndDefs.h"
+#include <cmath>
+#include <deque>
+#include <utility>
+#include <vector>
+
+/*
+ * Solvers only ever ask for d(a, b). A matrix answers with one load but needs n^2 doubles; geometric boards
+ * (cointoss, polygons) only need their coordinates, and a distance costs a few flops (no cache miss either).
+ * Distances computed on demand are bit-for-bit those generateTimes would have stored.
+ * Scope: this only removes the distance matrix. ACS and MMAS still keep pheromone, heuristic and choice matrices of
+ * n^2 doubles each, so they remain bounded by memory at about 24 n^2 bytes (some 10 GB at 20k holes). Only the island
+ * model builds colonies from coordinates; solverManager and main keep distance matrices, which CPLEX and .dat/binary
+ * instances need anyway.
+ */
+class distanceProvider {
+public:
+    distanceProvider() = default;
+    explicit distanceProvider(const doubleMap* _matrix);        // Matrix owned by the caller (never copied)
+    distanceProvider(const std::deque<std::pair<double, double>>& coordMap, int _distMode);
+
+    double operator()(int a, int b) const {
+        if (matrix != nullptr)
+            return (*matrix)[a][b];
+        return (distMode == MANHATTAN) ? metric<MANHATTAN>(xs[a], ys[a], xs[b], ys[b])
+                                       : metric<EUCLIDEAN>(xs[a], ys[a], xs[b], ys[b]);
+    }
+    int size() const { return numHoles; }
+    bool onDemand() const { return matrix == nullptr; }
+    bool symmetric() const;                 // Whether d(a,b) == d(b,a) everywhere (local search needs it)
+    void row(int a, double* out) const;     // out[b] = d(a, b) for every hole b
+    // Coordinates and metric (on demand only)
+    const std::vector<double>& xCoordinates() const { return xs; }
+    const std::vector<double>& yCoordinates() const { return ys; }
+    int metricMode() const { return distMode; }
+
+    // Distance between two points, with the metric (MANHATTAN or EUCLIDEAN) fixed at compile time
+    template <int MODE>
+    static double metric(double x1, double y1, double x2, double y2) {
+        double dx = x1 - x2, dy = y1 - y2;
+        return (MODE == MANHATTAN) ? std::abs(dx) + std::abs(dy) : std::sqrt(dx * dx + dy * dy);
+    }
+private:
+    const doubleMap* matrix = nullptr;
+    std::vector<double> xs, ys;             // Coordinates (on demand only)
+    int numHoles = 0, distMode = EUCLIDEAN;
+};
+
+#endif //DISTANCEPROVIDER_H
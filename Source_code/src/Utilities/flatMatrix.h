@@ -0,0 +1,166 @@
+#ifndef FLATMATRIX_H
+#define FLATMATRIX_H
+
+/**
+ * @file flatMatrix.h
+ * @brief Contiguous, cache-line aligned, row-major matrix.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Alignment of the first element of every row (one cache line, also enough for AVX-512 loads)
+#define MATRIX_ALIGNMENT 64
+
+/*
+ * All rows live in a single allocation. Each row starts on a cache line: the row length (stride) is
+ * rounded up to a whole number of cache lines, and the padding is zero-filled. SIMD loops may therefore
+ * always process full vectors up to stride(), without any tail handling.
+ * m[i][j] works as with the old vector of vectors (m[i] is a pointer to row i).
+ * A matrix may also be a view of memory it does not own (e.g. a mapped file, see binaryInstance): it is then never
+ * freed, and its copies own their values.
+ */
+template <typename T>
+class flatMatrix {
+    static_assert(std::is_trivially_copyable<T>::value, "flatMatrix only holds trivially copyable values");
+public:
+    flatMatrix() = default;
+    flatMatrix(std::size_t _rows, std::size_t _cols) { resize(_rows, _cols); }
+    flatMatrix(const flatMatrix& other) { copyFrom(other); }
+    flatMatrix(flatMatrix&& other) noexcept { swap(other); }
+    flatMatrix& operator=(const flatMatrix& other) {
+        if (this != &other) {
+            release();
+            copyFrom(other);
+        }
+        return *this;
+    }
+    flatMatrix& operator=(flatMatrix&& other) noexcept {
+        swap(other);
+        return *this;
+    }
+    ~flatMatrix() { release(); }
+
+    void resize(std::size_t _rows, std::size_t _cols) {
+        /**
+        * Allocate a _rows x _cols matrix, with all values (and padding) set to zero.
+        * Previous values are discarded.
+        * */
+        release();
+        numRows = _rows;
+        numCols = _cols;
+        rowStride = strideFor(_cols);
+        allocate();
+    }
+    static flatMatrix view(T* _values, std::size_t _rows, std::size_t _cols, std::size_t _stride) {
+        /**
+        * Matrix over values laid out as this class would: rows start every _stride elements, on MATRIX_ALIGNMENT
+        * bytes, and the padding is zero. The values must outlive the view.
+        * */
+        flatMatrix matrix;
+        matrix.values = _values;
+        matrix.numRows = _rows;
+        matrix.numCols = _cols;
+        matrix.rowStride = _stride;
+        return matrix;
+    }
+    void clear() { release(); }
+    void fill(T value) {
+        /* Set every value to "value" (padding is left at zero) */
+        for (std::size_t i = 0; i < numRows; i++)
+            for (std::size_t j = 0; j < numCols; j++)
+                values[i * rowStride + j] = value;
+    }
+    void swap(flatMatrix& other) noexcept {
+        std::swap(values, other.values);
+        std::swap(block, other.block);
+        std::swap(numRows, other.numRows);
+        std::swap(numCols, other.numCols);
+        std::swap(rowStride, other.rowStride);
+    }
+
+    T* operator[](std::size_t i) { return values + i * rowStride; }
+    const T* operator[](std::size_t i) const { return values + i * rowStride; }
+    T* data() { return values; }
+    const T* data() const { return values; }
+    // Number of rows (same meaning as size() of the old vector of vectors)
+    std::size_t size() const { return numRows; }
+    bool empty() const { return numRows == 0; }
+    std::size_t rows() const { return numRows; }
+    std::size_t cols() const { return numCols; }
+    // Distance (in elements) between the starts of two consecutive rows
+    std::size_t stride() const { return rowStride; }
+    // Whether the values belong to this matrix (false for a view)
+    bool owned() const { return block != nullptr || values == nullptr; }
+    // Row length that resize() would choose for _cols columns
+    static std::size_t strideFor(std::size_t _cols) {
+        const std::size_t perLine = MATRIX_ALIGNMENT / sizeof(T);
+        return ((_cols + perLine - 1) / perLine) * perLine;
+    }
+
+private:
+    void allocate() {
+        const std::size_t bytes = numRows * rowStride * sizeof(T);
+        if (bytes == 0)
+            return;
+        // Over-allocate and align by hand (portable to compilers without aligned_alloc)
+        block = static_cast<char*>(::operator new(bytes + MATRIX_ALIGNMENT));
+        auto address = reinterpret_cast<std::uintptr_t>(block);
+        auto offset = (MATRIX_ALIGNMENT - address % MATRIX_ALIGNMENT) % MATRIX_ALIGNMENT;
+        values = reinterpret_cast<T*>(block + offset);
+        std::memset(values, 0, bytes);
+    }
+    void copyFrom(const flatMatrix& other) {
+        numRows = other.numRows;
+        numCols = other.numCols;
+        rowStride = other.rowStride;
+        allocate();
+        if (values != nullptr)
+            std::memcpy(values, other.values, numRows * rowStride * sizeof(T));
+    }
+    void release() {
+        ::operator delete(block);
+        block = nullptr;
+        values = nullptr;
+        numRows = numCols = rowStride = 0;
+    }
+
+    T* values = nullptr;                    // First (aligned) element
+    char* block = nullptr;                  // Actual allocation (nullptr for a view)
+    std::size_t numRows = 0, numCols = 0, rowStride = 0;
+};
+
+/*
+ * Allocator of MATRIX_ALIGNMENT-aligned arrays, for containers of over-aligned types: before C++17, operator new (and
+ * so std::allocator) ignores alignas beyond the alignment of the largest scalar.
+ * Over-allocates and aligns by hand like flatMatrix; the actual allocation is stored just before the array.
+ */
+template <typename T>
+struct alignedAllocator {
+    typedef T value_type;
+    alignedAllocator() = default;
+    template <typename U> alignedAllocator(const alignedAllocator<U>&) noexcept {}
+
+    T* allocate(std::size_t count) {
+        // operator new returns at least pointer-aligned memory, so the offset always leaves room for the pointer
+        char* block = static_cast<char*>(::operator new(count * sizeof(T) + MATRIX_ALIGNMENT));
+        auto address = reinterpret_cast<std::uintptr_t>(block);
+        char* aligned = block + (MATRIX_ALIGNMENT - address % MATRIX_ALIGNMENT);
+        reinterpret_cast<char**>(aligned)[-1] = block;
+        return reinterpret_cast<T*>(aligned);
+    }
+    void deallocate(T* array, std::size_t) noexcept {
+        ::operator delete(reinterpret_cast<char**>(array)[-1]);
+    }
+};
+
+template <typename T, typename U>
+bool operator==(const alignedAllocator<T>&, const alignedAllocator<U>&) { return true; }
+template <typename T, typename U>
+bool operator!=(const alignedAllocator<T>&, const alignedAllocator<U>&) { return false; }
+
+#endif //FLATMATRIX_H
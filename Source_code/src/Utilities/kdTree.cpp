@@ -0,0 +1,142 @@
+#include "kdTree.h"
+#include "distanceProvider.h"
+#include <algorithm>
+#include <cmath>
+
+/**
+ * @file kdTree.h/cpp
+ * @brief 2-d tree over the holes of a board: k nearest neighbours of every hole in O(n log n).
+ */
+
+kdTree::kdTree(const std::vector<double>& _xs, const std::vector<double>& _ys) :
+        numHoles(static_cast<int>(_xs.size())), xs(_xs), ys(_ys)
+{
+    /**
+    * -- Parameters --
+    * const std::vector<double>& _xs, _ys   : coordinates of the holes
+    * */
+    index();
+}
+
+kdTree::kdTree(const std::deque<std::pair<double, double>>& coordMap) : numHoles(static_cast<int>(coordMap.size())) {
+    /**
+    * -- Parameters --
+    * const std::deque<std::pair<double, double>>& coordMap : coordinates of the holes
+    * */
+    xs.resize(numHoles);
+    ys.resize(numHoles);
+    for (int i=0; i<numHoles; i++) {
+        xs[i] = coordMap[i].first;
+        ys[i] = coordMap[i].second;
+    }
+    index();
+}
+
+void kdTree::index() {
+    /* Build the tree over the coordinates (O(n log n)) */
+    order.resize(numHoles);
+    for (int i=0; i<numHoles; i++)
+        order[i] = i;
+    splitAxis.assign(numHoles, 0);
+    build(0, numHoles);
+}
+
+void kdTree::build(int lo, int hi) {
+    /* Split order[lo, hi) at its middle, along the coordinate of larger spread, and recurse on both sides */
+    if (hi - lo <= KD_LEAF_SIZE)
+        return;
+    double minX = xs[order[lo]], maxX = minX, minY = ys[order[lo]], maxY = minY;
+    for (int t=lo+1; t<hi; t++) {
+        minX = std::min(minX, xs[order[t]]);
+        maxX = std::max(maxX, xs[order[t]]);
+        minY = std::min(minY, ys[order[t]]);
+        maxY = std::max(maxY, ys[order[t]]);
+    }
+    int mid = (lo + hi) / 2, axis = (maxY - minY > maxX - minX) ? 1 : 0;
+    const std::vector<double>& key = (axis == 0) ? xs : ys;
+    std::nth_element(order.begin() + lo, order.begin() + mid, order.begin() + hi,
+                     [&key](int a, int b) { return key[a] < key[b]; });
+    splitAxis[mid] = static_cast<unsigned char>(axis);
+    build(lo, mid);
+    build(mid + 1, hi);
+}
+
+void kdTree::nearest(int k, int distMode, intMap& lists, threadPool* pool) const {
+    /**
+    * Batched queries: the k nearest holes of every hole
+    * -- Parameters --
+    * int k             : number of holes in each list (at most numHoles-1)
+    * int distMode      : MANHATTAN or EUCLIDEAN
+    * intMap& lists     : lists[i] = the nearest holes of hole i, by increasing distance
+    * threadPool* pool  : workers sharing the queries (nullptr: run them on the calling thread)
+    * */
+    k = std::max(0, std::min(k, numHoles - 1));
+    lists.resize(numHoles);
+    auto queries = [this, k, distMode, &lists](int first, int last, unsigned) {
+        neighbourHeap best;
+        best.reserve(k + 1);
+        for (int i=first; i<last; i++) {
+            if (distMode == MANHATTAN)
+                nearestOf<MANHATTAN>(i, k, best, lists[i]);
+            else
+                nearestOf<EUCLIDEAN>(i, k, best, lists[i]);
+        }
+    };
+    if (pool == nullptr)
+        queries(0, numHoles, 0);
+    else
+        pool->parallelFor(numHoles, pool->chunkFor(numHoles), queries);
+}
+
+template <int MODE>
+void kdTree::nearestOf(int hole, int k, neighbourHeap& best, std::vector<int>& list) const {
+    /* k nearest holes of one hole, sorted */
+    best.clear();
+    if (k > 0)
+        search<MODE>(0, numHoles, hole, k, best);
+    std::sort_heap(best.begin(), best.end());
+    list.resize(best.size());
+    for (std::size_t t=0; t<best.size(); t++)
+        list[t] = best[t].second;
+}
+
+template <int MODE>
+void kdTree::search(int lo, int hi, int hole, int k, neighbourHeap& best) const {
+    /* Visit the range order[lo, hi): near side of the split first, far side only if it may hold a closer hole */
+    if (hi - lo <= KD_LEAF_SIZE) {
+        for (int t=lo; t<hi; t++)
+            consider<MODE>(order[t], hole, k, best);
+        return;
+    }
+    int mid = (lo + hi) / 2, split = order[mid];
+    consider<MODE>(split, hole, k, best);
+    double diff = (splitAxis[mid] == 0) ? xs[hole] - xs[split] : ys[hole] - ys[split];
+    bool low = diff < 0;
+    if (low)
+        search<MODE>(lo, mid, hole, k, best);
+    else
+        search<MODE>(mid + 1, hi, hole, k, best);
+    // Holes across the split are at least |diff| away (equal distances may still win on the index)
+    if (static_cast<int>(best.size()) == k && std::abs(diff) > best.front().first)
+        return;
+    if (low)
+        search<MODE>(mid + 1, hi, hole, k, best);
+    else
+        search<MODE>(lo, mid, hole, k, best);
+}
+
+template <int MODE>
+void kdTree::consider(int other, int hole, int k, neighbourHeap& best) const {
+    /* Keep other among the k best of hole, if it is closer than the worst of them */
+    if (other == hole)
+        return;
+    std::pair<double, int> entry(distanceProvider::metric<MODE>(xs[hole], ys[hole], xs[other], ys[other]), other);
+    if (static_cast<int>(best.size()) < k) {
+        best.push_back(entry);
+        std::push_heap(best.begin(), best.end());
+    } else if (entry < best.front()) {
+        std::pop_heap(best.begin(), best.end());
+        best.back() = entry;
+        std::push_heap(best.begin(), best.end());
+    }
+}
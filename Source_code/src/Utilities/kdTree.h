@@ -0,0 +1,44 @@
+#ifndef KDTREE_H
+#define KDTREE_H
+
+/**
+ * @file kdTree.h/cpp
+ * @brief 2-d tree over the holes of a board: k nearest neighbours of every hole in O(n log n).
+ */
+
+#include "typesAndDefs.h"
+#include "threadPool.h"
+#include <deque>
+#include <utility>
+#include <vector>
+
+// Ranges of at most this many holes are scanned instead of split
+#define KD_LEAF_SIZE 8
+
+/*
+ * Implicit, balanced tree: holes are permuted so that the middle hole of every range splits it (along the
+ * coordinate of larger spread), holes before it on the low side and holes after it on the high side.
+ * The distance along the split axis is a lower bound of both metrics, so the same search serves
+ * EUCLIDEAN and MANHATTAN.
+ */
+class kdTree {
+public:
+    kdTree(const std::vector<double>& _xs, const std::vector<double>& _ys);
+    explicit kdTree(const std::deque<std::pair<double, double>>& coordMap);
+    // k nearest holes of every hole (itself excluded), by increasing distance, ties to the lowest index
+    void nearest(int k, int distMode, intMap& lists, threadPool* pool = nullptr) const;
+private:
+    typedef std::vector<std::pair<double, int>> neighbourHeap;     // (distance, hole), largest on top
+    void index();
+    void build(int lo, int hi);
+    template <int MODE> void nearestOf(int hole, int k, neighbourHeap& best, std::vector<int>& list) const;
+    template <int MODE> void search(int lo, int hi, int hole, int k, neighbourHeap& best) const;
+    template <int MODE> void consider(int other, int hole, int k, neighbourHeap& best) const;
+
+    int numHoles;
+    std::vector<double> xs, ys;
+    std::vector<int> order;                 // Holes, in tree order
+    std::vector<unsigned char> splitAxis;   // Split axis (0: x, 1: y) of the range whose middle is at i
+};
+
+#endif //KDTREE_H
@@ -0,0 +1,76 @@
+#ifndef POWERS_H
+#define POWERS_H
+
+/**
+ * @file powers.h
+ * @brief x^e specialised at compile time on small integer exponents, with a runtime dispatcher.
+ */
+
+#include <cmath>
+#include <type_traits>
+
+// Largest integer exponent with a specialised power (multiplications only)
+#define MAX_INT_EXPONENT 4
+// Id of any other exponent: std::pow is used
+#define GENERIC_EXPONENT 0
+
+/*
+ * power<E>::of(x, e) is x^e, with E the id of e (see exponentId). Loops computing powers are written once as a
+ * generic lambda and run through withExponent, which instantiates them for the id of the exponent:
+ *     withExponent(exponentId(alpha), [&](auto a) { ... power<decltype(a)::value>::of(x, alpha) ... });
+ */
+template <int E>
+struct power {
+    static double of(double x, double e) { return power<E - 1>::of(x, e) * x; }
+};
+
+template <>
+struct power<1> {
+    static double of(double x, double) { return x; }
+};
+
+template <>
+struct power<GENERIC_EXPONENT> {
+    static double of(double x, double e) { return std::pow(x, e); }
+};
+
+inline int exponentId(double e) {
+    /**
+    * -- Parameters --
+    * double e  : exponent
+    * -- Return --
+    * e if it is an integer between 1 and MAX_INT_EXPONENT, GENERIC_EXPONENT otherwise
+    * */
+    for (int k=1; k<=MAX_INT_EXPONENT; k++)
+        if (e == k)
+            return k;
+    return GENERIC_EXPONENT;
+}
+
+template <typename F>
+inline void withExponent(int id, F&& f) {
+    /**
+    * Call f with std::integral_constant<int, id>: f is compiled once per exponent id
+    * -- Parameters --
+    * int id    : exponent id (see exponentId)
+    * F&& f     : callable taking an integral constant
+    * */
+    switch (id) {
+        case 1:
+            f(std::integral_constant<int, 1>());
+            break;
+        case 2:
+            f(std::integral_constant<int, 2>());
+            break;
+        case 3:
+            f(std::integral_constant<int, 3>());
+            break;
+        case 4:
+            f(std::integral_constant<int, 4>());
+            break;
+        default:
+            f(std::integral_constant<int, GENERIC_EXPONENT>());
+    }
+}
+
+#endif //POWERS_H
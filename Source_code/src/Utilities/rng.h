@@ -0,0 +1,59 @@
+#ifndef RNG_H
+#define RNG_H
+
+/**
+ * @file rng.h
+ * @brief Small and fast random number streams (xoshiro256+), derived from a single master seed.
+ */
+
+#include <cstdint>
+
+class rngStream {
+public:
+    rngStream() { seed(0, 0); }
+    rngStream(uint64_t masterSeed, uint64_t streamId) { seed(masterSeed, streamId); }
+
+    void seed(uint64_t masterSeed, uint64_t streamId) {
+        /**
+        * Derive the state of stream "streamId" from the master seed.
+        * SplitMix64 scrambles (seed, id) so that nearby ids give unrelated streams.
+        * -- Parameters --
+        * uint64_t masterSeed   : seed shared by all the streams of a run
+        * uint64_t streamId     : index of this stream (e.g. the id of the ant using it)
+        * */
+        uint64_t x = masterSeed ^ (0x9E3779B97F4A7C15ULL * (streamId + 1));
+        for (auto& word : s)
+            word = splitMix64(x);
+    }
+    uint64_t next() {
+        /* xoshiro256+ step */
+        const uint64_t result = s[0] + s[3];
+        const uint64_t t = s[1] << 17;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 45);
+        return result;
+    }
+    double nextDouble() {
+        /* Uniform double in [0, 1) (53 upper bits of the output) */
+        return static_cast<double>(next() >> 11) * (1.0 / 9007199254740992.0);
+    }
+    int nextInt(int n) {
+        /* Uniform integer in [0, n) (multiply-shift, negligible bias for small n) */
+        return static_cast<int>(((next() >> 32) * static_cast<uint64_t>(n)) >> 32);
+    }
+    static uint64_t splitMix64(uint64_t& x) {
+        uint64_t z = (x += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+private:
+    static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+    uint64_t s[4];
+};
+
+#endif //RNG_H
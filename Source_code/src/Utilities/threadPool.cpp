@@ -0,0 +1,105 @@
+#include "threadPool.h"
+#include <algorithm>
+
+/**
+ * @file threadPool.h/cpp
+ * @brief Long-lived worker threads, reused by every parallel loop of a solver.
+ */
+
+threadPool::threadPool(unsigned numThreads) {
+    /**
+    * Start the worker threads. They sleep until a parallel loop is submitted.
+    * -- Parameters --
+    * unsigned numThreads   : total number of threads, caller included (0: number of hardware threads)
+    * */
+    if (numThreads == 0)
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+    workers.reserve(numThreads - 1);
+    for (unsigned w = 1; w < numThreads; w++)
+        workers.emplace_back(&threadPool::workerLoop, this, w);
+}
+
+threadPool::~threadPool() {
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers)
+        worker.join();
+}
+
+int threadPool::chunkFor(int n) const {
+    /* About four chunks per worker, at least one index each */
+    return std::max(1, n / static_cast<int>(4 * size()));
+}
+
+void threadPool::runChunks(unsigned workerId) {
+    /**
+    * Take chunks of the current loop until none is left
+    * -- Parameters --
+    * unsigned workerId     : id of the worker running the chunks
+    * */
+    int chunk;
+    while ((chunk = nextChunk.fetch_add(1)) < (jobSize + jobChunk - 1) / jobChunk) {
+        int first = chunk * jobChunk;
+        (*job)(first, std::min(jobSize, first + jobChunk), workerId);
+    }
+}
+
+void threadPool::workerLoop(unsigned workerId) {
+    /**
+    * Wait for a loop to be submitted, help running it, repeat until the pool is destroyed
+    * -- Parameters --
+    * unsigned workerId     : id of the worker (1 to size()-1)
+    * */
+    unsigned long seen = 0;
+    std::unique_lock<std::mutex> lock(stateMutex);
+    while (true) {
+        wake.wait(lock, [this, seen] { return stopping || generation != seen; });
+        if (stopping)
+            return;
+        seen = generation;
+        lock.unlock();
+        runChunks(workerId);
+        lock.lock();
+        if (--running == 0)
+            finished.notify_one();
+    }
+}
+
+void threadPool::parallelFor(int n, int chunkSize, const chunkBody& body) {
+    /**
+    * Run body on all indices in [0, n), split in chunks. Chunks are taken dynamically by the workers
+    * (caller included), so faster workers take more of them. Returns once every chunk is done.
+    * NOTE: body must not call parallelFor on the same pool.
+    * -- Parameters --
+    * int n                 : number of indices
+    * int chunkSize         : number of consecutive indices handed to a worker at once
+    * const chunkBody& body : work to do on a chunk
+    * */
+    if (n <= 0)
+        return;
+    chunkSize = std::max(1, chunkSize);
+    // Nothing to share: run on the caller
+    if (workers.empty() || n <= chunkSize) {
+        for (int first = 0; first < n; first += chunkSize)
+            body(first, std::min(n, first + chunkSize), 0);
+        return;
+    }
+    std::lock_guard<std::mutex> submit(submitMutex);
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        job = &body;
+        jobSize = n;
+        jobChunk = chunkSize;
+        nextChunk = 0;
+        running = static_cast<unsigned>(workers.size());
+        generation++;
+    }
+    wake.notify_all();
+    runChunks(0);
+    std::unique_lock<std::mutex> lock(stateMutex);
+    finished.wait(lock, [this] { return running == 0; });
+    job = nullptr;
+}
@@ -0,0 +1,49 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+/**
+ * @file threadPool.h/cpp
+ * @brief Long-lived worker threads, reused by every parallel loop of a solver.
+ */
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Body of a parallel loop: (first index, last index (excluded), worker id in [0, size()))
+typedef std::function<void(int, int, unsigned)> chunkBody;
+
+class threadPool {
+public:
+    // numThreads = 0: one thread per hardware core. The calling thread counts as worker 0.
+    explicit threadPool(unsigned numThreads = 0);
+    ~threadPool();
+    threadPool(const threadPool&) = delete;
+    threadPool& operator=(const threadPool&) = delete;
+
+    unsigned size() const { return static_cast<unsigned>(workers.size()) + 1; }
+    // Run body over [0, n) in chunks of (at most) chunkSize indices, and wait for all of them.
+    void parallelFor(int n, int chunkSize, const chunkBody& body);
+    // A chunk size that gives every worker a few chunks to balance the load
+    int chunkFor(int n) const;
+private:
+    void workerLoop(unsigned workerId);
+    void runChunks(unsigned workerId);
+
+    std::vector<std::thread> workers;
+    std::mutex submitMutex;                 // One parallel loop at a time
+    std::mutex stateMutex;
+    std::condition_variable wake, finished;
+    // --- Current loop ---
+    const chunkBody* job = nullptr;
+    int jobSize = 0, jobChunk = 1;
+    std::atomic<int> nextChunk{0};
+    unsigned running = 0;                   // Workers still busy on the current loop
+    unsigned long generation = 0;           // Incremented for every new loop
+    bool stopping = false;
+};
+
+#endif //THREADPOOL_H
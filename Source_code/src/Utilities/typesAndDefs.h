@@ -8,10 +8,17 @@
 
 #include <iostream>
 #include <vector>
+#include "flatMatrix.h"
 // Used for index maps
 typedef std::vector<std::vector<int>> intMap;
-// Used for "distance" maps
-typedef std::vector<std::vector<double>> doubleMap;
+// Used for "distance" maps (contiguous, row-major, padded rows)
+typedef flatMatrix<double> doubleMap;
+
+// VECTOR KERNELS
+// Kernel sets of the state transition rule (see antKernels), from the most portable to the fastest
+#define KERNELS_SCALAR 0
+#define KERNELS_AVX2 1
+#define KERNELS_AVX512 2
 
 // Parameters
 struct ACSparameters{
@@ -23,6 +30,16 @@ struct ACSparameters{
     double omega;
     double greediness;
     int distMode;
+    int candidateListSize;      // Nearest holes considered at each step (0: consider all holes)
+    unsigned long long seed;    // Master seed of the random streams (0: time-based seed)
+    int localUpdateMode;        // How concurrent ants apply local pheromone updates (see LOCAL UPDATE MODES)
+    int localSearchMode;        // Local search applied to the tours (LOCAL_SEARCH_* flags, see LOCAL SEARCH)
+    int localSearchScope;       // Which tours are improved (LOCAL_SEARCH_EVERY_ANT or _ITERATION_BEST)
+    int kicks;                  // Chained LK kicks applied to the best tour once ACS is over (0: none)
+    long timeLimit;             // Wall-clock budget of a run in milliseconds (0: no limit, see STOPPING CRITERIA)
+    int stallLimit;             // Stop after this many iterations without a shorter tour (0: never)
+    double targetObj;           // Stop once the best tour is this short (0: no target, or TARGET_OPTIMAL)
+    int vectorKernels = KERNELS_AVX512; // Fastest vector kernels the ants may use (capped at what the CPU supports)
 };
 
 // Assume arbitrary 200x200 board. Assume a max diagonal of ~280 (200*sqrt(2))
@@ -48,10 +65,56 @@ struct ACSparameters{
 #define UPPER_BOUND 3
 #define NUM_TESTS 4
 #define NUM_PARAMS 5
+#define BENCHMARK_RUNS 2
+// First argument: convert the '.dat' files that follow to binary instances
+#define CONVERT_OPTION "--convert"
+// Only argument: run the consistency checks of unitTest (CHECK_TESTS random rows per kernel check), exit code 1 on failure
+#define CHECK_OPTION "--check"
+#define CHECK_TESTS 200
 
 // DISTANCES
 #define MANHATTAN 0
 #define EUCLIDEAN 1
 
+// LOCAL UPDATE MODES
+// Relaxed: ants update shared trails as they move (relaxed atomics, racing updates may be lost).
+// Fastest, not reproducible.
+#define LOCAL_UPDATE_RELAXED 0
+// Deferred: ants read the trails of the previous iteration, their updates are merged after all ants are done
+#define LOCAL_UPDATE_DEFERRED 1
+// Deterministic: ants move in lock-step, updates of each step are applied in ant order before the next step
+#define LOCAL_UPDATE_DETERMINISTIC 2
+// None: trails only change in the global update (MAX-MIN Ant System)
+#define LOCAL_UPDATE_NONE 3
+// Asynchronous: relaxed updates, and no iterations: workers keep building tours, the global update runs whenever a
+// shorter tour is found and every numAnts tours. No barrier, not reproducible.
+#define LOCAL_UPDATE_ASYNCHRONOUS 4
+
+// LOCAL SEARCH
+// Operators (flags, may be combined). Only used on symmetric instances.
+#define LOCAL_SEARCH_NONE 0
+#define LOCAL_SEARCH_2OPT 1
+#define LOCAL_SEARCH_OROPT 2
+#define LOCAL_SEARCH_LK 4
+// Scope: improve the tour of every ant, or only the best tour of each iteration
+#define LOCAL_SEARCH_EVERY_ANT 0
+#define LOCAL_SEARCH_ITERATION_BEST 1
+// Neighbour list size of the local search, when candidate lists are disabled
+#define LOCAL_SEARCH_NEIGHBOURS 10
+// Gains smaller than this are treated as rounding noise
+#define LS_EPSILON 1e-9
+
+// STOPPING CRITERIA
+// What ended a run: the iteration count always applies, the other criteria only if set in ACSparameters
+#define STOP_RUNNING -1
+#define STOP_ITERATIONS 0
+#define STOP_TIME_LIMIT 1
+#define STOP_STALL 2
+#define STOP_TARGET 3
+// Target objective: the optimal solution given to the solver (no target if it is unknown)
+#define TARGET_OPTIMAL -1
+// Relative tolerance on the target objective (the optimal solution may be rounded)
+#define TARGET_TOLERANCE 1e-9
+
 
 #endif //TYPESANDDEFS_H
@@ -1,6 +1,12 @@
 #include "unitTest.h"
 #include <sstream>
 #include <fstream>
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
 /**
  * @file unitTest.h/cpp
  * @brief run multiple tests and collect statistics.
@@ -33,6 +39,279 @@ void unitTest::runTests( char **argv, unsigned numTests, ACSparameters params, b
     mng.solveAllWithStats(true);
 }
 
+void unitTest::benchmarkACS(const doubleMap& times, const std::vector<std::pair<std::string, ACSparameters>>& configs,
+                            unsigned numTests) {
+    /**
+    * Benchmark ACS configurations (no CPLEX): each one is run numTests times on the same instance
+    * -- Parameters --
+    * const doubleMap& times                                            : distance matrix of the instance
+    * const std::vector<std::pair<std::string, ACSparameters>>& configs : name and parameters of each configuration
+    * unsigned numTests                                                 : number of runs of each configuration
+    * */
+    std::cout << "-- ACS benchmark (" << times.size() << " holes, " << numTests << " runs each) --" << std::endl;
+    for (const auto& config : configs) {
+        std::vector<double> objectives, timings;
+        for (unsigned i=0; i<numTests; i++) {
+            ACSHeuristic ants(config.second, &times, -1, true);
+            ants.optimize();
+            objectives.emplace_back(ants.getObj());
+            timings.emplace_back(ants.getTime());
+        }
+        printBenchmark(config.first, objectives, timings);
+    }
+}
+
+void unitTest::benchmarkMMAS(const doubleMap& times, const std::vector<std::pair<std::string, ACSparameters>>& configs,
+                             unsigned numTests) {
+    /**
+    * Benchmark MAX-MIN Ant System configurations (no CPLEX), same output as benchmarkACS
+    * -- Parameters --
+    * const doubleMap& times                                            : distance matrix of the instance
+    * const std::vector<std::pair<std::string, ACSparameters>>& configs : name and parameters of each configuration
+    * unsigned numTests                                                 : number of runs of each configuration
+    * */
+    std::cout << "-- MMAS benchmark (" << times.size() << " holes, " << numTests << " runs each) --" << std::endl;
+    for (const auto& config : configs) {
+        std::vector<double> objectives, timings;
+        for (unsigned i=0; i<numTests; i++) {
+            MMASHeuristic ants(config.second, &times, -1, true);
+            ants.optimize();
+            objectives.emplace_back(ants.getObj());
+            timings.emplace_back(ants.getTime());
+        }
+        printBenchmark(config.first, objectives, timings);
+    }
+}
+
+void unitTest::benchmarkIslands(const doubleMap& times, const ACSparameters& params, int numIslands,
+                                unsigned numTests) {
+    /**
+    * Benchmark the island model (no CPLEX): numIslands colonies of params.numAnts ants, against one colony of
+    * numIslands * params.numAnts ants using every thread
+    * -- Parameters --
+    * const doubleMap& times        : distance matrix of the instance
+    * const ACSparameters& params   : parameters of a colony (spread over the islands)
+    * int numIslands                : number of islands
+    * unsigned numTests             : number of runs of each configuration
+    * */
+    std::cout << "-- Island model benchmark (" << times.size() << " holes, " << numTests << " runs each) --"
+              << std::endl;
+    std::vector<double> objectives, timings;
+    ACSparameters single = params;
+    single.numAnts = numIslands * params.numAnts;
+    for (unsigned i=0; i<numTests; i++) {
+        ACSHeuristic ants(single, &times, -1, true);
+        ants.optimize();
+        objectives.emplace_back(ants.getObj());
+        timings.emplace_back(ants.getTime());
+    }
+    printBenchmark("Single colony", objectives, timings);
+    objectives.clear();
+    timings.clear();
+    islandModel islands(islandModel::spread(params, numIslands), &times, -1);
+    for (unsigned i=0; i<numTests; i++) {
+        islands.optimize();
+        objectives.emplace_back(islands.getObj());
+        timings.emplace_back(islands.getTime());
+        islands.reset();
+    }
+    printBenchmark(std::to_string(numIslands) + " islands", objectives, timings);
+}
+
+void unitTest::printBenchmark(const std::string& name, const std::vector<double>& objectives,
+                              const std::vector<double>& timings) {
+    /**
+    * Print one line of a benchmark: time and objective statistics of a configuration
+    * */
+    if (objectives.empty())
+        return;
+    double meanObj, stdevObj, meanTime, stdevTime;
+    Utils::stdev(objectives, meanObj, stdevObj);
+    Utils::stdev(timings, meanTime, stdevTime);
+    std::cout << "    " << std::left << std::setw(24) << name << std::right
+              << " | Avg time (s): " << std::setprecision(4) << meanTime/1000
+              << " | Stdev (s): " << std::setprecision(4) << stdevTime/1000
+              << " | Avg obj: " << std::setprecision(6) << meanObj
+              << " | Min obj: " << *std::min_element(objectives.begin(), objectives.end())
+              << " | Stdev obj: " << std::setprecision(4) << stdevObj << std::endl;
+}
+
+void unitTest::benchmarkLK(const doubleMap& times, int kicks, unsigned numTests) {
+    /**
+    * Benchmark chained LK on its own (no ACS), from nearest neighbour tours with random starting holes
+    * -- Parameters --
+    * const doubleMap& times    : distance matrix of the instance (symmetric)
+    * int kicks                 : number of kicks of each run
+    * unsigned numTests         : number of runs
+    * */
+    std::cout << "-- Chained LK benchmark (" << times.size() << " holes, " << kicks << " kicks, " << numTests
+              << " runs) --" << std::endl;
+    std::vector<double> objectives, timings;
+    distanceProvider distances(&times);
+    intMap neighbours;
+    localSearch::nearestHoles(distances, LOCAL_SEARCH_NEIGHBOURS, neighbours);
+    localSearch improver;
+    improver.init(distances.size(), &distances, &neighbours);
+    auto seed = static_cast<uint64_t>(std::chrono::high_resolution_clock::now().time_since_epoch().count());
+    std::vector<int> tour;
+    for (unsigned i=0; i<numTests; i++) {
+        rngStream rng(seed, i);
+        auto start = std::chrono::high_resolution_clock::now();
+        double length = localSearch::nearestNeighbourTour(distances, neighbours, rng.nextInt(distances.size()), tour);
+        length += improver.chainedLK(tour, kicks, rng);
+        auto end = std::chrono::high_resolution_clock::now();
+        objectives.emplace_back(length);
+        timings.emplace_back(std::chrono::duration_cast<std::chrono::milliseconds>(end-start).count());
+    }
+    printBenchmark("Chained LK alone", objectives, timings);
+}
+
+bool unitTest::checkKernels(unsigned numTests) {
+    /**
+    * Compare argmax and roulette wheel selection (maskWeights, then search) of every kernel set supported by the
+    * CPU with the scalar kernels, on random rows and visited masks. Rows of every length from 1 to 67 holes (and a
+    * few longer ones): most end in padding, as when the number of holes is not a multiple of the vector width.
+    * Rows also have ties and zero weights. The roulette point may only fall on another hole if it lies on the
+    * boundary between two holes (the running sums of the kernels differ by rounding).
+    * -- Parameters --
+    * unsigned numTests         : random rows and masks per row length
+    * -- Return --
+    * Whether every supported kernel set agrees with the scalar kernels
+    * */
+    const antKernels& reference = antKernels::select(KERNELS_SCALAR);
+    rngStream rng(static_cast<uint64_t>(std::chrono::high_resolution_clock::now().time_since_epoch().count()), 0);
+    std::vector<int> rowLengths = {100, 257, 1001};
+    for (int holes = 1; holes <= 67; holes++)
+        rowLengths.push_back(holes);
+    bool allPassed = true;
+    for (int level : {KERNELS_AVX2, KERNELS_AVX512}) {
+        const antKernels& kernels = antKernels::select(level);
+        if (kernels.level != level) {
+            std::cout << "    Kernels " << level << " not supported by this CPU: skipped" << std::endl;
+            continue;
+        }
+        long failures = 0, checks = 0;
+        for (int holes : rowLengths) {
+            doubleMap rows(2, holes);       // Row 0: weights, row 1: masked weights
+            int n = static_cast<int>(rows.stride());
+            std::vector<uint64_t> visited((n + 63) / 64);
+            for (unsigned t = 0; t < numTests; t++) {
+                // Weights: a few distinct values (ties), some zeros. Visited holes: random, padding always
+                for (int j = 0; j < holes; j++)
+                    rows[0][j] = (rng.nextInt(8) == 0) ? 0.0 : (1 + rng.nextInt(4)) * (rng.nextInt(2) ? 1.0 : 1e-3);
+                std::fill(visited.begin(), visited.end(), 0);
+                int visitedShare = rng.nextInt(4);
+                for (int j = 0; j < n; j++)
+                    if (j >= holes || rng.nextInt(4) < visitedShare)
+                        visited[j >> 6] |= uint64_t(1) << (j & 63);
+                checks++;
+                // -- argmax: exactly the same hole --
+                bool passed = kernels.argmax(rows[0], visited.data(), n) == reference.argmax(rows[0], visited.data(), n);
+                // -- roulette wheel: same masked row, same sum (up to rounding), same hole --
+                double sum = kernels.maskWeights(rows[0], visited.data(), n, rows[1]);
+                std::vector<double> masked(rows[1], rows[1] + n);
+                double referenceSum = reference.maskWeights(rows[0], visited.data(), n, rows[1]);
+                passed = passed && std::equal(masked.begin(), masked.end(), rows[1])
+                         && std::abs(sum - referenceSum) <= 1e-12 * referenceSum;
+                if (referenceSum > 0.0) {
+                    double point = rng.nextDouble() * referenceSum;
+                    int hole = kernels.search(rows[1], n, point), referenceHole = reference.search(rows[1], n, point);
+                    if (hole != referenceHole) {
+                        // Only allowed within rounding of a boundary of the wheel
+                        double running = 0.0, nearest = referenceSum;
+                        for (int j = 0; j < n; j++) {
+                            running += rows[1][j];
+                            nearest = std::min(nearest, std::abs(running - point));
+                        }
+                        passed = passed && nearest <= 1e-12 * referenceSum;
+                    }
+                }
+                if (!passed)
+                    failures++;
+            }
+        }
+        std::cout << "    Kernels " << std::left << std::setw(16) << kernels.name << std::right << " : " << checks
+                  << " rows checked, " << failures << " mismatch(es)" << std::endl;
+        allPassed = allPassed && failures == 0;
+    }
+    return allPassed;
+}
+
+bool unitTest::checkBinaryInstance(const std::string& filename) {
+    /**
+    * Save random instances (float64 and float32, with coordinates) and load them back, then load corrupted copies
+    * of the float64 file: each must be rejected. Sizes in the corrupted headers are chosen so that the products
+    * computed from them wrap around.
+    * -- Parameters --
+    * const std::string& filename   : scratch file (overwritten, then removed)
+    * -- Return --
+    * Whether every instance was read back unchanged and every corrupted file rejected
+    * */
+    const int holes = 37;           // Not a multiple of the values per cache line: rows are padded
+    rngStream rng(static_cast<uint64_t>(std::chrono::high_resolution_clock::now().time_since_epoch().count()), 0);
+    std::deque<std::pair<double, double>> coordMap;
+    for (int i = 0; i < holes; i++)
+        coordMap.emplace_back(rng.nextDouble() * 100, rng.nextDouble() * 100);
+    doubleMap times(holes, holes);
+    for (int i = 0; i < holes; i++)
+        for (int j = 0; j < holes; j++)
+            times[i][j] = std::hypot(coordMap[i].first - coordMap[j].first, coordMap[i].second - coordMap[j].second);
+    bool allPassed = true;
+    // -- Round trips --
+    for (int dtype : {BINARY_FLOAT64, BINARY_FLOAT32}) {
+        binaryInstance instance;
+        bool passed = binaryInstance::save(filename, times, EUCLIDEAN, &coordMap, dtype)
+                      && instance.load(filename) == holes && instance.metric() == EUCLIDEAN && instance.symmetric()
+                      && instance.coordinates() == coordMap
+                      && instance.mapped() == (dtype == BINARY_FLOAT64);   // float32 rows are converted (copied)
+        for (int i = 0; passed && i < holes; i++)
+            for (int j = 0; j < holes; j++)
+                passed = passed && instance.matrix()[i][j] == ((dtype == BINARY_FLOAT64) ? times[i][j]
+                                                         : static_cast<double>(static_cast<float>(times[i][j])));
+        std::cout << "    Round trip (" << ((dtype == BINARY_FLOAT64) ? "float64" : "float32") << ")     : "
+                  << (passed ? "passed" : "FAILED") << std::endl;
+        allPassed = allPassed && passed;
+    }
+    // -- Corrupted files --
+    binaryInstance::save(filename, times, EUCLIDEAN, &coordMap);
+    std::ifstream in(filename, std::ios::binary);
+    const std::vector<char> file((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    in.close();
+    auto setField = [](std::vector<char>& bytes, std::size_t offset, uint64_t value) {
+        std::memcpy(bytes.data() + offset, &value, sizeof(value));
+    };
+    std::vector<std::pair<std::string, std::vector<char>>> corrupted;
+    corrupted.emplace_back("no header", std::vector<char>(file.begin(), file.begin() + sizeof(binaryHeader) / 2));
+    corrupted.emplace_back("truncated", std::vector<char>(file.begin(), file.end() - 1));
+    corrupted.emplace_back("version", file);
+    corrupted.back().second[offsetof(binaryHeader, version)]++;
+    corrupted.emplace_back("byte order", file);
+    std::reverse(corrupted.back().second.begin() + offsetof(binaryHeader, byteOrder),
+                 corrupted.back().second.begin() + offsetof(binaryHeader, byteOrder) + sizeof(uint32_t));
+    corrupted.emplace_back("type", file);
+    corrupted.back().second[offsetof(binaryHeader, dtype)] = 7;
+    corrupted.emplace_back("holes * stride", file);           // 2^32 * 2^32 * 8 wraps to 0
+    setField(corrupted.back().second, offsetof(binaryHeader, numHoles), uint64_t(1) << 32);
+    setField(corrupted.back().second, offsetof(binaryHeader, stride), uint64_t(1) << 32);
+    corrupted.emplace_back("stride", file);                   // 2^61 * 8 wraps to 0
+    setField(corrupted.back().second, offsetof(binaryHeader, stride), uint64_t(1) << 61);
+    corrupted.emplace_back("matrix offset", file);
+    setField(corrupted.back().second, offsetof(binaryHeader, matrixOffset), ~uint64_t(0) - (MATRIX_ALIGNMENT - 1));
+    corrupted.emplace_back("coordinate offset", file);
+    setField(corrupted.back().second, offsetof(binaryHeader, coordOffset), ~uint64_t(0) - 8);
+    for (auto& c : corrupted) {
+        std::ofstream(filename, std::ios::binary | std::ios::trunc).write(c.second.data(),
+                                                                          static_cast<std::streamsize>(c.second.size()));
+        binaryInstance instance;
+        bool passed = instance.load(filename) < 0 && instance.size() == 0;
+        std::cout << "    Corrupted (" << std::left << std::setw(17) << c.first << std::right << ") : "
+                  << (passed ? "rejected" : "ACCEPTED") << std::endl;
+        allPassed = allPassed && passed;
+    }
+    std::remove(filename.c_str());
+    return allPassed;
+}
+
 void unitTest::printResults() {
 
     // Outer vector  : num_intervals number of different instances (with different number of holes)
@@ -8,16 +8,35 @@
 
 #include "../Solvers/solverManager.h"
 #include "../Utilities/utils.h"
+#include "../Utilities/binaryInstance.h"
 #include "../Solvers/Ant Colony System/ACSHeuristic.h"
+#include "../Solvers/Ant Colony System/MMASHeuristic.h"
+#include "../Solvers/Ant Colony System/islandModel.h"
 #include <iomanip>
 
 class unitTest {
 public:
     unitTest();
     void runTests(char **argv, unsigned numTests, ACSparameters params, boardType type);
+    // Run the ACS heuristic with different parameters on the same instance, compare times and objectives
+    static void benchmarkACS(const doubleMap& times, const std::vector<std::pair<std::string, ACSparameters>>& configs,
+                             unsigned numTests);
+    // Same comparison for MAX-MIN Ant System, and for chained LK on its own
+    static void benchmarkMMAS(const doubleMap& times, const std::vector<std::pair<std::string, ACSparameters>>& configs,
+                              unsigned numTests);
+    static void benchmarkLK(const doubleMap& times, int kicks, unsigned numTests);
+    // Island model against a single colony with the same total number of ants
+    static void benchmarkIslands(const doubleMap& times, const ACSparameters& params, int numIslands,
+                                 unsigned numTests);
+    // Checks: every supported set of vector kernels against the scalar one (random rows and masks)
+    static bool checkKernels(unsigned numTests);
+    // Binary instances: save and load back, and corrupted files (truncated, wrong header, overflowing sizes)
+    static bool checkBinaryInstance(const std::string& filename);
     void printResults();
     void saveResults();
 private:
+    static void printBenchmark(const std::string& name, const std::vector<double>& objectives,
+                               const std::vector<double>& timings);
     // doubleMap loadedDistances;
     // The number of holes for each instance
     std::vector<int> numHoles;
@@ -136,7 +136,7 @@ void Utils::saveToDAT(doubleMap& times) {
     /**
     * Save distance matrix to a DAT file
     * -- Parameters --
-    * doubleMap &times             : Matrix (vector of vectors) of distances/times to be filled
+    * doubleMap &times             : Matrix of distances/times to be saved
     **/
     unsigned long side = times.size();
     std::ofstream outputFile;
@@ -164,16 +164,14 @@ long Utils::loadFromDAT(doubleMap &times, const std::string &filename) {
     /**
     * Load distance matrix from a DAT file
     * -- Parameters --
-    * doubleMap &times                  : Matrix (vector of vectors) of distances/times to be filled
+    * doubleMap &times                  : Matrix of distances/times to be filled
     * const std::string& filename       : name of the file to load
     **/
     int numHoles;
     std::ifstream in(filename);
     in >> numHoles;
     // --- Allocation ---
-    times.resize(numHoles);
-    for (int i = 0; i < numHoles; i++)
-        times[i].resize(numHoles);
+    times.resize(numHoles, numHoles);
     // --- Generation ---
     for (int i = 0; i < numHoles; i++){
         // Iterate neighbor of holes
@@ -1,5 +1,6 @@
 #include "Solvers/solverManager.h"
 #include "Utilities/unitTest.h"
+#include "Utilities/binaryInstance.h"
 #include <climits>
 
 /**
@@ -17,16 +18,32 @@ int main(int argc, char** argv) {
     std::cout << "---------------------------------------" << std::endl;
     ACSparameters params = {40, 800, 1.0,
                             4.0, .8, .1,
-                            .95, EUCLIDEAN};
+                            .95, EUCLIDEAN, 0, 0, LOCAL_UPDATE_RELAXED,
+                            LOCAL_SEARCH_NONE, LOCAL_SEARCH_EVERY_ANT, 0,
+                            0, 0, 0};
+    bool convert = argc >= 2 && std::string(argv[FILENAME]) == CONVERT_OPTION;
+    bool check = argc == 2 && std::string(argv[FILENAME]) == CHECK_OPTION;
+    int exitCode = 0;
+    int benchmarkRuns = 0;
     try {
-        if (argc > NUM_PARAMS || argc == 1)
+        if ((!convert && (argc > NUM_PARAMS || argc == 1)) || (convert && argc == 2))
             throw std::runtime_error(std::string(__FILE__) + ": " + "\nIncorrect usage of parameters!");
+        if (!convert && argc == 3) {
+            // Benchmark: at least one run of each configuration (statistics of no run are undefined)
+            try {
+                benchmarkRuns = std::stoi(argv[BENCHMARK_RUNS]);
+            } catch(std::exception&) {
+                benchmarkRuns = 0;
+            }
+            if (benchmarkRuns <= 0)
+                throw std::runtime_error(std::string(__FILE__) + ": " + "\nIncorrect usage of parameters!");
+        }
 
     } catch(std::exception& e)
     {
         std::cout << ">>>EXCEPTION: " << e.what() << std::endl;
         std::cout << "Usage [1] (string): "
-                     "\n(1) Path of '.dat' file to open."
+                     "\n(1) Path of '.dat' (or binary '" BINARY_EXTENSION "') file to open."
                   << std::endl;
         std::cout << "Usage [2] (int values): "
                      "\n(1) Number of problems for each size."
@@ -34,13 +51,43 @@ int main(int argc, char** argv) {
                      "\n(3) Upper bound."
                      "\n(4) Number of tests to run (on same instance, average is taken)."
                   << std::endl;
+        std::cout << "Usage [3] (string, int): "
+                     "\n(1) Path of '.dat' file to open."
+                     "\n(2) Number of runs of each ACS configuration (benchmark, no CPLEX)."
+                  << std::endl;
+        std::cout << "Usage [4] (" CONVERT_OPTION ", strings): "
+                     "\n(1..) Paths of '.dat' files to convert to binary '" BINARY_EXTENSION "' files (same name)."
+                  << std::endl;
+        std::cout << "Usage [5] (" CHECK_OPTION "): "
+                     "\n Check the vector kernels against the scalar ones, and reading binary instances back."
+                  << std::endl;
         return 0;
     }
-    if(argc == 2) {
+    if (check) {
+        // -----------------------------------
+        // ------- Consistency checks --------
+        std::cout << "-- Vector kernels --" << std::endl;
+        if (!unitTest::checkKernels(CHECK_TESTS))
+            exitCode = 1;
+        std::cout << "-- Binary instances --" << std::endl;
+        if (!unitTest::checkBinaryInstance("check_instance" BINARY_EXTENSION))
+            exitCode = 1;
+        std::cout << "Checks " << ((exitCode == 0) ? "passed." : "FAILED.") << std::endl;
+    } else if (convert) {
+        // -----------------------------------
+        // ---- Convert instances to binary ----
+        for (int f = FILENAME + 1; f < argc; f++)
+            binaryInstance::convertDAT(argv[f], binaryInstance::binaryName(argv[f]));
+    } else if(argc == 2) {
         // -----------------------------------
         // ----- Test specific instances -----
-        doubleMap times;
-        Utils::loadFromDAT(times, argv[FILENAME]);
+        // Binary instances are mapped: their matrix is used in place
+        binaryInstance instance;
+        if (instance.load(argv[FILENAME]) < 0)
+            return 0;
+        std::cout << "Instance of " << instance.size() << " holes "
+                  << (instance.mapped() ? "(mapped, used in place)" : "(parsed)") << std::endl;
+        const doubleMap& times = instance.matrix();
         int test_pool = 10;
         double best = -1;
         std::vector<double> results;
@@ -101,6 +148,48 @@ int main(int argc, char** argv) {
         std::cout << "Solution is " << std::setprecision(4) << Utils::percentDifference(mean, best)
                   << "% off the optimal solution." << std::endl;
 
+    } else if (argc == 3) {
+        // -----------------------------------
+        // ---- Benchmark ACS configurations ---
+        binaryInstance instance;
+        if (instance.load(argv[FILENAME]) < 0)
+            return 0;
+        std::cout << "Instance of " << instance.size() << " holes "
+                  << (instance.mapped() ? "(mapped, used in place)" : "(parsed)") << std::endl;
+        const doubleMap& times = instance.matrix();
+        std::vector<std::pair<std::string, ACSparameters>> configs;
+        ACSparameters relaxed = params, deferred = params, deterministic = params, antTwoOpt = params,
+                bestTwoOpt = params, antOrOpt = params, chainedLK = params, stalled = params,
+                asynchronous = params;
+        deferred.localUpdateMode = LOCAL_UPDATE_DEFERRED;
+        deterministic.localUpdateMode = LOCAL_UPDATE_DETERMINISTIC;
+        asynchronous.localUpdateMode = LOCAL_UPDATE_ASYNCHRONOUS;
+        antTwoOpt.localSearchMode = bestTwoOpt.localSearchMode = LOCAL_SEARCH_2OPT;
+        bestTwoOpt.localSearchScope = LOCAL_SEARCH_ITERATION_BEST;
+        antOrOpt.localSearchMode = LOCAL_SEARCH_2OPT | LOCAL_SEARCH_OROPT;
+        chainedLK.localSearchMode = LOCAL_SEARCH_LK;
+        chainedLK.localSearchScope = LOCAL_SEARCH_ITERATION_BEST;
+        chainedLK.kicks = static_cast<int>(times.size());
+        stalled.stallLimit = params.iterations / 8;
+        configs.emplace_back("Relaxed local updates", relaxed);
+        configs.emplace_back("Deferred local updates", deferred);
+        configs.emplace_back("Deterministic updates", deterministic);
+        configs.emplace_back("Asynchronous ants", asynchronous);
+        configs.emplace_back("2-opt on every ant", antTwoOpt);
+        configs.emplace_back("2-opt on iteration best", bestTwoOpt);
+        configs.emplace_back("2-opt + Or-opt, every ant", antOrOpt);
+        configs.emplace_back("LK + chained LK on best", chainedLK);
+        configs.emplace_back("Stop on stagnation", stalled);
+        unitTest::benchmarkACS(times, configs, benchmarkRuns);
+        std::vector<std::pair<std::string, ACSparameters>> mmasConfigs;
+        ACSparameters mmas = params, mmasTwoOpt = params;
+        mmas.omega = mmasTwoOpt.omega = 0.02;
+        mmasTwoOpt.localSearchMode = LOCAL_SEARCH_2OPT;
+        mmasConfigs.emplace_back("MAX-MIN Ant System", mmas);
+        mmasConfigs.emplace_back("MMAS + 2-opt every ant", mmasTwoOpt);
+        unitTest::benchmarkMMAS(times, mmasConfigs, benchmarkRuns);
+        unitTest::benchmarkLK(times, static_cast<int>(times.size()), benchmarkRuns);
+        unitTest::benchmarkIslands(times, params, 4, benchmarkRuns);
     } else {
         // -----------------------------------
         // -- Test various generated boards --
@@ -113,5 +202,5 @@ int main(int argc, char** argv) {
     std::cout << "---------------------------------------" << std::endl;
     std::cout << "Programing ending..." << std::endl;
     std::cout << "---------------------------------------" << std::endl;
-    return 0;
+    return exitCode;
 }
\ No newline at end of file